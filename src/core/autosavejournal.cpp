@@ -0,0 +1,391 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "autosavejournal.h"
+#include <QDataStream>
+#include <QFile>
+#include <filesystem>
+
+namespace {
+constexpr quint32 journalMagic = 0x504f544a; // "POTJ"
+constexpr quint32 journalVersion = 1;
+// records are written after the edits paused for flushDelay, but at least every maxFlushDelay
+constexpr int flushDelay = 1000;
+constexpr int maxFlushDelay = 5000;
+// the journal is compacted if it is larger than minCompactionSize and
+// compactionFactor times larger than its snapshot
+constexpr qint64 minCompactionSize = 256 * 1024;
+constexpr qint64 compactionFactor = 4;
+
+enum RecordType : quint8 {
+    SnapshotRecord = 1,
+    TextInsertRecord,
+    TextRemoveRecord,
+    GeometryRecord,
+    ConfigurationRecord
+};
+
+void writeGeometry(QDataStream& out, MemberBoxGeometry const& geometry) {
+    out << qint32(geometry.rect.left()) << qint32(geometry.rect.top())
+        << qint32(geometry.rect.width()) << qint32(geometry.rect.height()) << geometry.angle;
+}
+
+MemberBoxGeometry readGeometry(QDataStream& in) {
+    qint32 x = 0, y = 0, width = 0, height = 0;
+    double angle = 0;
+    in >> x >> y >> width >> height >> angle;
+    return {angle, QRect(x, y, width, height)};
+}
+
+void writeConfiguration(QDataStream& out, ConfigBoxes const& configuration) {
+    out << quint32(configuration.entries().size());
+    for(auto const& [id, config] : configuration.entries()) {
+        out << id;
+        writeGeometry(out, config.geometry);
+    }
+}
+
+ConfigBoxes readConfiguration(QDataStream& in) {
+    ConfigBoxes configuration;
+    quint32 size = 0;
+    in >> size;
+    for(quint32 i = 0; i < size && in.status() == QDataStream::Ok; i++) {
+        QString id;
+        in >> id;
+        auto const geometry = readGeometry(in);
+        configuration.addRect(geometry, id);
+    }
+    return configuration;
+}
+
+// writes the header and a snapshot record, returns the number of written bytes or -1
+qint64 writeSnapshot(QString const& fileName, AutosaveState const& state) {
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return -1;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << journalMagic << journalVersion << quint8(SnapshotRecord) << state.text;
+    writeConfiguration(out, state.configuration);
+    if(out.status() != QDataStream::Ok) {
+        return -1;
+    }
+    return file.size();
+}
+
+void insertText(QStringList& lines, int line, int column, QString const& text) {
+    if(line < 0 || line >= lines.size() || column < 0 || column > lines[line].size()) {
+        return;
+    }
+    auto parts = text.split('\n');
+    parts.first().prepend(lines[line].left(column));
+    parts.last().append(lines[line].mid(column));
+    lines[line] = parts.first();
+    for(int i = 1; i < parts.size(); i++) {
+        lines.insert(line + i, parts[i]);
+    }
+}
+
+void removeText(QStringList& lines, int startLine, int startColumn, int endLine, int endColumn) {
+    if(startLine < 0 || endLine >= lines.size() || startLine > endLine) {
+        return;
+    }
+    lines[startLine] = lines[startLine].left(startColumn) + lines[endLine].mid(endColumn);
+    lines.erase(lines.begin() + startLine + 1, lines.begin() + endLine + 1);
+}
+}
+
+AutosaveJournal::AutosaveJournal(QObject* parent)
+    : QObject(parent)
+{
+    mFlushTimer.setSingleShot(true);
+    connect(&mFlushTimer, &QTimer::timeout, this, &AutosaveJournal::flush);
+    mThreadPool.setMaxThreadCount(1);
+}
+
+AutosaveJournal::~AutosaveJournal() {
+    flush();
+    discardCompaction();
+}
+
+void AutosaveJournal::open(QString const& fileName, SnapshotFunction snapshot) {
+    close();
+    mFileName = fileName;
+    mSnapshot = snapshot;
+}
+
+void AutosaveJournal::close() {
+    flush();
+    discardCompaction();
+    mGeneration++;
+    mStarted = false;
+    mFileName.clear();
+    mSnapshot = nullptr;
+}
+
+void AutosaveJournal::remove() {
+    mFlushTimer.stop();
+    mPendingText.clear();
+    mPendingConfiguration.reset();
+    mPendingGeometries.clear();
+    discardCompaction();
+    mGeneration++;
+    mStarted = false;
+    if(!mFileName.isEmpty()) {
+        QFile::remove(mFileName);
+    }
+}
+
+QString AutosaveJournal::fileName() const {
+    return mFileName;
+}
+
+bool AutosaveJournal::exists() const {
+    return !mFileName.isEmpty() && QFile::exists(mFileName);
+}
+
+void AutosaveJournal::appendTextInsert(int line, int column, QString const& text) {
+    if(!beginRecord()) {
+        return;
+    }
+    QDataStream out(&mPendingText, QIODevice::WriteOnly | QIODevice::Append);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << quint8(TextInsertRecord) << qint32(line) << qint32(column) << text;
+    scheduleFlush();
+}
+
+void AutosaveJournal::appendTextRemove(int startLine, int startColumn, int endLine, int endColumn) {
+    if(!beginRecord()) {
+        return;
+    }
+    QDataStream out(&mPendingText, QIODevice::WriteOnly | QIODevice::Append);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << quint8(TextRemoveRecord) << qint32(startLine) << qint32(startColumn)
+        << qint32(endLine) << qint32(endColumn);
+    scheduleFlush();
+}
+
+void AutosaveJournal::appendGeometry(QString const& boxId, std::optional<MemberBoxGeometry> const& geometry) {
+    if(!beginRecord()) {
+        return;
+    }
+    // only the last geometry of a box between two flushes is needed, e.g. while dragging
+    mPendingGeometries[boxId] = geometry;
+    scheduleFlush();
+}
+
+void AutosaveJournal::appendConfiguration(ConfigBoxes const& configuration) {
+    if(!beginRecord()) {
+        return;
+    }
+    mPendingGeometries.clear();
+    mPendingConfiguration = configuration;
+    scheduleFlush();
+}
+
+bool AutosaveJournal::beginRecord() {
+    if(mFileName.isEmpty() || !mSnapshot) {
+        return false;
+    }
+    if(mStarted) {
+        return true;
+    }
+    // the journal starts with the first edit, the snapshot already contains this edit
+    mStarted = true;
+    mSnapshotSize = writeSnapshot(mFileName, mSnapshot());
+    return false;
+}
+
+void AutosaveJournal::scheduleFlush() {
+    if(!mFlushTimer.isActive()) {
+        mOldestPendingRecord.start();
+    }
+    if(mOldestPendingRecord.elapsed() >= maxFlushDelay) {
+        flush();
+        return;
+    }
+    mFlushTimer.start(flushDelay);
+}
+
+void AutosaveJournal::flush() {
+    mFlushTimer.stop();
+    if(mPendingText.isEmpty() && !mPendingConfiguration && mPendingGeometries.empty()) {
+        return;
+    }
+    QByteArray records;
+    {
+        QDataStream out(&records, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_15);
+        if(mPendingConfiguration) {
+            out << quint8(ConfigurationRecord);
+            writeConfiguration(out, *mPendingConfiguration);
+        }
+        for(auto const& [boxId, geometry] : mPendingGeometries) {
+            out << quint8(GeometryRecord) << boxId << geometry.has_value();
+            if(geometry) {
+                writeGeometry(out, *geometry);
+            }
+        }
+    }
+    records.append(mPendingText);
+    mPendingText.clear();
+    mPendingConfiguration.reset();
+    mPendingGeometries.clear();
+
+    QFile file(mFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return;
+    }
+    file.write(records);
+    auto const size = file.size();
+    file.close();
+
+    if(mCompacting) {
+        mCompactionBacklog.append(records);
+    }
+    else if(size > minCompactionSize && size > compactionFactor * mSnapshotSize) {
+        compact();
+    }
+}
+
+void AutosaveJournal::compact() {
+    mCompacting = true;
+    auto const state = mSnapshot();
+    auto const fileName = compactionFileName();
+    auto const generation = mGeneration;
+    mThreadPool.start([this, state, fileName, generation]{
+        auto const snapshotSize = writeSnapshot(fileName, state);
+        QMetaObject::invokeMethod(this, [this, generation, snapshotSize]{
+            finishCompaction(generation, snapshotSize);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AutosaveJournal::finishCompaction(int generation, qint64 snapshotSize) {
+    // the journal was closed or removed in the meantime
+    if(generation != mGeneration) {
+        return;
+    }
+    mCompacting = false;
+    auto const fileName = compactionFileName();
+    QFile file(fileName);
+    if(snapshotSize < 0 || !file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        mCompactionBacklog.clear();
+        QFile::remove(fileName);
+        return;
+    }
+    file.write(mCompactionBacklog);
+    file.close();
+    mCompactionBacklog.clear();
+
+    // replaces the journal atomically, a crash leaves either the old or the compacted journal
+    std::error_code error;
+    std::filesystem::rename(fileName.toStdString(), mFileName.toStdString(), error);
+    if(error) {
+        QFile::remove(fileName);
+        return;
+    }
+    mSnapshotSize = snapshotSize;
+}
+
+void AutosaveJournal::discardCompaction() {
+    if(!mCompacting) {
+        return;
+    }
+    mThreadPool.waitForDone();
+    mCompacting = false;
+    mCompactionBacklog.clear();
+    QFile::remove(compactionFileName());
+}
+
+QString AutosaveJournal::compactionFileName() const {
+    return mFileName + ".compact";
+}
+
+std::optional<AutosaveState> AutosaveJournal::replay(QString const& fileName) {
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if(in.status() != QDataStream::Ok || magic != journalMagic || version != journalVersion) {
+        return {};
+    }
+
+    bool hasSnapshot = false;
+    QStringList lines;
+    ConfigBoxes configuration;
+    // records are only applied if they were read completely,
+    // the last record can be truncated if the application crashed while writing
+    while(!in.atEnd()) {
+        quint8 type = 0;
+        in >> type;
+        if(type == SnapshotRecord) {
+            QString text;
+            in >> text;
+            auto const snapshotConfiguration = readConfiguration(in);
+            if(in.status() != QDataStream::Ok) {
+                break;
+            }
+            lines = text.split('\n');
+            configuration = snapshotConfiguration;
+            hasSnapshot = true;
+        }
+        else if(type == TextInsertRecord) {
+            qint32 line = 0, column = 0;
+            QString text;
+            in >> line >> column >> text;
+            if(in.status() != QDataStream::Ok) {
+                break;
+            }
+            insertText(lines, line, column, text);
+        }
+        else if(type == TextRemoveRecord) {
+            qint32 startLine = 0, startColumn = 0, endLine = 0, endColumn = 0;
+            in >> startLine >> startColumn >> endLine >> endColumn;
+            if(in.status() != QDataStream::Ok) {
+                break;
+            }
+            removeText(lines, startLine, startColumn, endLine, endColumn);
+        }
+        else if(type == GeometryRecord) {
+            QString boxId;
+            bool hasGeometry = false;
+            in >> boxId >> hasGeometry;
+            MemberBoxGeometry geometry;
+            if(hasGeometry) {
+                geometry = readGeometry(in);
+            }
+            if(in.status() != QDataStream::Ok) {
+                break;
+            }
+            if(hasGeometry) {
+                configuration.addRect(geometry, boxId);
+            }
+            else {
+                configuration.deleteRect(boxId);
+            }
+        }
+        else if(type == ConfigurationRecord) {
+            auto const newConfiguration = readConfiguration(in);
+            if(in.status() != QDataStream::Ok) {
+                break;
+            }
+            configuration = newConfiguration;
+        }
+        else {
+            break;
+        }
+    }
+    if(!hasSnapshot) {
+        return {};
+    }
+    return AutosaveState{lines.join('\n'), configuration};
+}
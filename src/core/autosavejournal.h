@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef AUTOSAVEJOURNAL_H
+#define AUTOSAVEJOURNAL_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <functional>
+#include <optional>
+#include "configboxes.h"
+
+struct AutosaveState {
+    QString text;
+    ConfigBoxes configuration;
+};
+
+// Append-only log of the edits since the last save.
+// The journal starts with a snapshot of the text and the configuration,
+// every following edit is appended as small record. Records are buffered
+// and written to disk after the edits pause, so one edit costs only the size of the edit.
+// If the journal grew too much, it is compacted to a new snapshot in the background.
+class AutosaveJournal : public QObject
+{
+    Q_OBJECT
+public:
+    using SnapshotFunction = std::function<AutosaveState()>;
+
+    AutosaveJournal(QObject* parent = nullptr);
+    ~AutosaveJournal();
+
+    // starts recording into the file, nothing is written until the first edit
+    void open(QString const& fileName, SnapshotFunction snapshot);
+    // stops recording, the file stays on disk
+    void close();
+    // stops recording and deletes the file, e.g. after the document was saved
+    void remove();
+    QString fileName() const;
+    bool exists() const;
+
+    // positions are the line and column of the text document
+    void appendTextInsert(int line, int column, QString const& text);
+    void appendTextRemove(int startLine, int startColumn, int endLine, int endColumn);
+    // no geometry means that the configuration entry of the box was deleted
+    void appendGeometry(QString const& boxId, std::optional<MemberBoxGeometry> const& geometry);
+    void appendConfiguration(ConfigBoxes const& configuration);
+
+    // writes all buffered records
+    void flush();
+
+    // replays the records of the journal, a truncated last record is ignored
+    static std::optional<AutosaveState> replay(QString const& fileName);
+
+private:
+    bool beginRecord();
+    void scheduleFlush();
+    void compact();
+    void finishCompaction(int generation, qint64 snapshotSize);
+    void discardCompaction();
+    QString compactionFileName() const;
+
+private:
+    QString mFileName;
+    SnapshotFunction mSnapshot;
+    bool mStarted = false;
+    // increased on open, close and remove to drop results of outdated compactions
+    int mGeneration = 0;
+
+    QByteArray mPendingText;
+    std::optional<ConfigBoxes> mPendingConfiguration;
+    std::map<QString, std::optional<MemberBoxGeometry>> mPendingGeometries;
+    QTimer mFlushTimer;
+    QElapsedTimer mOldestPendingRecord;
+
+    qint64 mSnapshotSize = 0;
+    bool mCompacting = false;
+    // records written while the compaction runs, they are appended to the compacted journal
+    QByteArray mCompactionBacklog;
+    QThreadPool mThreadPool;
+};
+
+#endif // AUTOSAVEJOURNAL_H
@@ -5,7 +5,13 @@
 */
 
 #include "box.h"
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QRegularExpression>
+#include <QHash>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
 
 namespace{
 Qt::PenStyle CSSToPenStyle(QString cssStyle) {
@@ -17,6 +23,124 @@ Qt::PenStyle CSSToPenStyle(QString cssStyle) {
     }
     return Qt::PenStyle::SolidLine;
 }
+
+std::size_t hashValue(QString const& value) {
+    return qHash(value);
+}
+std::size_t hashValue(QColor const& value) {
+    return qHash(quint64(value.rgba64()));
+}
+std::size_t hashValue(double value) {
+    return qHash(value);
+}
+std::size_t hashValue(int value) {
+    return qHash(value);
+}
+std::size_t hashValue(bool value) {
+    return qHash(int(value));
+}
+std::size_t hashValue(FontWeight value) {
+    return qHash(int(value));
+}
+std::size_t hashValue(Qt::Alignment value) {
+    return qHash(int(value));
+}
+
+template<typename T>
+void writeOptional(QDataStream& stream, std::optional<T> const& value) {
+    stream << value.has_value();
+    if(!value) {
+        return;
+    }
+    if constexpr(std::is_enum_v<T> || std::is_same_v<T, Qt::Alignment>) {
+        stream << int(*value);
+    }
+    else {
+        stream << *value;
+    }
+}
+
+template<typename T>
+void combineHash(std::size_t& seed, std::optional<T> const& value) {
+    auto const hash = value ? hashValue(*value) + 1 : 0;
+    seed ^= hash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+}
+
+// the shared instances carry the digest of their values, so fingerprints do not serialize them again
+BoxAppearance::Interned::Interned(BoxAppearance const& appearance)
+    : BoxAppearance(appearance)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    writeOptional(stream, mLanguage);
+    writeOptional(stream, mColor);
+    writeOptional(stream, mBackgroundColor);
+    writeOptional(stream, mFontSize);
+    writeOptional(stream, mLineSpacing);
+    writeOptional(stream, mFontWeight);
+    writeOptional(stream, mFont);
+    writeOptional(stream, mAlignment);
+    writeOptional(stream, mOpacity);
+    writeOptional(stream, mPadding);
+    writeOptional(stream, mBorderRadius);
+    writeOptional(stream, mHighlight);
+    writeOptional(stream, mBorder.width);
+    writeOptional(stream, mBorder.style);
+    writeOptional(stream, mBorder.color);
+    writeOptional(stream, mTextMarker.color);
+    writeOptional(stream, mTextMarker.fontWeight);
+    mDigest = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+std::size_t BoxAppearance::hash() const {
+    std::size_t seed = 0;
+    combineHash(seed, mLanguage);
+    combineHash(seed, mColor);
+    combineHash(seed, mBackgroundColor);
+    combineHash(seed, mFontSize);
+    combineHash(seed, mLineSpacing);
+    combineHash(seed, mFontWeight);
+    combineHash(seed, mFont);
+    combineHash(seed, mAlignment);
+    combineHash(seed, mOpacity);
+    combineHash(seed, mPadding);
+    combineHash(seed, mBorderRadius);
+    combineHash(seed, mHighlight);
+    combineHash(seed, mBorder.width);
+    combineHash(seed, mBorder.style);
+    combineHash(seed, mBorder.color);
+    combineHash(seed, mTextMarker.color);
+    combineHash(seed, mTextMarker.fontWeight);
+    return seed;
+}
+
+BoxAppearance::Ptr BoxAppearance::intern(BoxAppearance const& appearance) {
+    // the table only holds weak references, appearances no box uses anymore are released
+    static std::mutex mutex;
+    static std::unordered_multimap<std::size_t, std::weak_ptr<Interned const>> table;
+    static int insertions = 0;
+
+    auto const hash = appearance.hash();
+    std::lock_guard lock(mutex);
+    auto const [begin, end] = table.equal_range(hash);
+    for(auto it = begin; it != end; it++) {
+        if(auto existing = it->second.lock(); existing && *existing == appearance) {
+            return existing;
+        }
+    }
+    if(++insertions % 1024 == 0) {
+        std::erase_if(table, [](auto const& entry){ return entry.second.expired(); });
+    }
+    auto interned = Ptr(new Interned(appearance));
+    table.emplace(hash, interned);
+    return interned;
+}
+
+BoxAppearance::Ptr const& BoxAppearance::empty() {
+    static auto const emptyAppearance = intern({});
+    return emptyAppearance;
 }
 
 
@@ -56,23 +180,15 @@ int Box::line() const {
     return style().line();
 }
 
-void Box::startDraw(QPainter &painter) {
+void Box::startDraw(QPainter &painter) const {
     painter.save();
 
-    // geometry
-    auto rect = style().mGeometry.rect();
-    rect.moveLeft(mStyle.mGeometry.leftDisplay());
-    rect.moveTop(mStyle.mGeometry.topDisplay());
-    rect.setWidth(mStyle.mGeometry.widthDisplay());
-    rect.setHeight(mStyle.mGeometry.heightDisplay());
-    style().mGeometry.setAngle(mStyle.mGeometry.angleDisplay());
-
     painter.setTransform(style().mGeometry.transform());
     painter.setRenderHint(QPainter::Antialiasing);
 
     // font
     auto font = painter.font();
-    if(mStyle.mFontWeight == FontWeight::bold){
+    if(mStyle.fontWeight() == FontWeight::bold){
         font.setBold(true);
         painter.setFont(font);
     }
@@ -88,7 +204,7 @@ void Box::endDraw(QPainter &painter) const{
     painter.restore();
 }
 
-void Box::drawManipulationSlide(QPainter &painter, int size){
+void Box::drawManipulationSlide(QPainter &painter, int size) const {
     PainterTransformScope scope(this, painter);
     auto pen = painter.pen();
     pen.setColor(Qt::black);
@@ -109,13 +225,13 @@ void Box::drawManipulationSlide(QPainter &painter, int size){
     painter.drawRect(QRect(rect.bottomRight() + QPoint(size/2, size/2), QSize(-size, -size)));
 }
 
-void Box::drawGlobalBoxSettings(QPainter &painter) {
+void Box::drawGlobalBoxSettings(QPainter &painter) const {
     PainterTransformScope scope(this, painter);
 
     auto const rect = geometry().rect();
 
     // background Color
-    if(style().mBackgroundColor) {
+    if(style().appearance().mBackgroundColor) {
         painter.save();
         painter.setBrush(mStyle.backgroundColor());
         painter.setPen(Qt::NoPen);
@@ -145,10 +261,22 @@ void Box::drawGlobalBoxSettings(QPainter &painter) {
     }
 }
 
-bool Box::containsPoint(QPoint point, int margin) const {
+bool Box::containsPoint(QPoint point, int margin, BoxRenderOutput const&) const {
     return geometry().contains(point, margin);
 }
 
+QRect Box::paintedRect(BoxRenderOutput const&) const {
+    return geometry().rect();
+}
+
+void Box::writeFingerprint(QDataStream& stream, PresentationContext const&) const {
+    stream << QByteArray(typeid(*this).name()) << mStyle.text() << mStyle.geometry().rect() << mStyle.geometry().angleDisplay()
+           << int(mPause.mDisplayMode) << mPause.mCount << mStyle.mAppearance->digest();
+}
+
+void Box::writeResourceFingerprint(QDataStream&, PresentationContext const&) const {
+}
+
 void Box::setBoxStyle(BoxStyle style){
     mStyle = style;
 }
@@ -10,8 +10,12 @@
 #include <QPainter>
 #include <memory>
 #include <optional>
+#include <unordered_map>
 #include "boxgeometry.h"
 
+class QDataStream;
+class ImageFileEmbedder;
+
 using Variables = std::map<QString, QString>;
 
 enum PresentationRenderHints {
@@ -73,16 +77,20 @@ struct PresentationContext {
     int mPagenumber;
     int mTotalnumberofPages = 0;
     TableOfContent mTableOfContent = {};
+    // pixels per slide unit images are downsampled to when exporting, 0 keeps the resolution of the files
+    double mMaximalImageResolution = 0;
+    // image files which are embedded unchanged when exporting, nullptr draws all images
+    ImageFileEmbedder* mImageFileEmbedder = nullptr;
 };
 
-// when adding properties here, add them in PotatoFormateVisitor and Presentation
-struct BoxStyle{
-    QString mId = "";
-    std::optional<QString> mClass;
-    int mLine = 0;
-    std::optional<QString> mConfigId;
+// Appearance of a box, e.g. colors and font.
+// Boxes with the same appearance share one immutable instance created by BoxAppearance::intern,
+// so two appearances are equal if and only if their pointers are equal.
+struct BoxAppearance {
+    class Interned;
+    using Ptr = std::shared_ptr<Interned const>;
+
     std::optional<QString> mLanguage;
-    bool movable = true;
     std::optional<QColor> mColor;
     std::optional<QColor> mBackgroundColor;
     std::optional<int> mFontSize;
@@ -91,68 +99,118 @@ struct BoxStyle{
     std::optional<QString> mFont;
     std::optional<Qt::Alignment> mAlignment;
     std::optional<double> mOpacity;
-    std::optional<QString> mDefineclass;
-    std::optional<QString> mText;
-    BoxGeometry mGeometry;
     std::optional<int> mPadding;
     std::optional<int> mBorderRadius;
     std::optional<bool> mHighlight;
-    struct {
+    struct Border {
         std::optional<int> width;
         std::optional<QString> style;
         std::optional<QColor> color;
+        bool operator==(Border const&) const = default;
     } mBorder;
-    struct {
+    struct TextMarker {
         std::optional<QColor> color;
         std::optional<FontWeight> fontWeight;
+        bool operator==(TextMarker const&) const = default;
     } mTextMarker;
 
+    bool operator==(BoxAppearance const&) const = default;
+    std::size_t hash() const;
+
+    // returns the shared instance with the values of appearance
+    static Ptr intern(BoxAppearance const& appearance);
+    // the shared instance without any value set
+    static Ptr const& empty();
+};
+
+// shared instance of an appearance, only BoxAppearance::intern creates one
+class BoxAppearance::Interned : public BoxAppearance {
+public:
+    // digest of the values, it is computed once when the instance is interned
+    QByteArray const& digest() const {
+        return mDigest;
+    }
+
+private:
+    friend struct BoxAppearance;
+    explicit Interned(BoxAppearance const& appearance);
+
+    QByteArray mDigest;
+};
+
+// when adding properties here, add them in PotatoFormateVisitor and Presentation
+struct BoxStyle{
+    QString mId = "";
+    std::optional<QString> mClass;
+    int mLine = 0;
+    std::optional<QString> mConfigId;
+    bool movable = true;
+    std::optional<QString> mDefineclass;
+    std::optional<QString> mText;
+    BoxGeometry mGeometry;
+    BoxAppearance::Ptr mAppearance = BoxAppearance::empty();
+
+    BoxAppearance const& appearance() const {
+        return *mAppearance;
+    }
+    // appearances are immutable, a changed appearance is interned again
+    void setAppearance(BoxAppearance const& appearance) {
+        if(!(appearance == *mAppearance)) {
+            mAppearance = BoxAppearance::intern(appearance);
+        }
+    }
+    bool sameAppearance(BoxStyle const& other) const {
+        return mAppearance == other.mAppearance;
+    }
+
     QColor color() const {
-        return mColor.value_or(Qt::black);
+        return mAppearance->mColor.value_or(Qt::black);
     }
     QColor backgroundColor() const {
-        return mBackgroundColor.value_or(Qt::white);
+        return mAppearance->mBackgroundColor.value_or(Qt::white);
     }
     int fontSize() const {
-        return mFontSize.value_or(26);
+        return mAppearance->mFontSize.value_or(26);
     }
     double linespacing() const {
-        return mLineSpacing.value_or(1.15);
+        return mAppearance->mLineSpacing.value_or(1.15);
     }
     FontWeight fontWeight() const {
-        return mFontWeight.value_or(FontWeight::normal);
+        return mAppearance->mFontWeight.value_or(FontWeight::normal);
     }
     QString font() const {
-        return mFont.value_or("DejaVu Sans");
+        return mAppearance->mFont.value_or("DejaVu Sans");
     }
     Qt::Alignment alignment() const {
-        return mAlignment.value_or(Qt::AlignLeft);
+        return mAppearance->mAlignment.value_or(Qt::AlignLeft);
     }
     double opacity() const {
-        return mOpacity.value_or(1);
+        return mAppearance->mOpacity.value_or(1);
     }
     bool empty() const {
-        return !(mColor.has_value() || mFontSize.has_value() || mLineSpacing.has_value() || mFontWeight.has_value()
-                || mFont.has_value() || mAlignment.has_value() || mOpacity.has_value()) && mGeometry.empty();
+        auto const& appearance = *mAppearance;
+        return !(appearance.mColor.has_value() || appearance.mFontSize.has_value() || appearance.mLineSpacing.has_value()
+                 || appearance.mFontWeight.has_value() || appearance.mFont.has_value() || appearance.mAlignment.has_value()
+                 || appearance.mOpacity.has_value()) && mGeometry.empty();
     }
     bool hasBorder() const {
         // CSS standard says style has to be given
-        return mBorder.style.has_value();
+        return mAppearance->mBorder.style.has_value();
     }
     int borderWidth() const {
-        return mBorder.width.value_or(5);
+        return mAppearance->mBorder.width.value_or(5);
     }
     QColor borderColor() const {
-        return mBorder.color.value_or(Qt::black);
+        return mAppearance->mBorder.color.value_or(Qt::black);
     }
     QString borderStyle() const {
-        return mBorder.style.value_or("solid");
+        return mAppearance->mBorder.style.value_or("solid");
     }
     QColor markerColor() const {
-        return mTextMarker.color.value_or(color());
+        return mAppearance->mTextMarker.color.value_or(color());
     }
     FontWeight markerFontWeight() const {
-        return mTextMarker.fontWeight.value_or(fontWeight());
+        return mAppearance->mTextMarker.fontWeight.value_or(fontWeight());
     }
     QString getClass() const {
         return mClass.value_or("default");
@@ -170,10 +228,10 @@ struct BoxStyle{
         return mText.value_or("");
     }
     int padding() const {
-        return mPadding.value_or(0);
+        return mAppearance->mPadding.value_or(0);
     }
     int borderRadius() const {
-        return mBorderRadius.value_or(0);
+        return mAppearance->mBorderRadius.value_or(0);
     }
 
     QRect paintableRect() const {
@@ -185,14 +243,52 @@ struct BoxStyle{
     }
 
     QString language() const {
-        return mLanguage.value_or("");
+        return mAppearance->mLanguage.value_or("");
     }
 
     bool highlight() const {
-        return mHighlight.value_or(true);
+        return mAppearance->mHighlight.value_or(true);
+    }
+};
+
+struct TextBoundings {
+    std::vector<QRectF> lineBoundingRects;
+
+    bool contains(QPoint point, int margin, BoxGeometry geometry) const {
+        point = geometry.transform().inverted().map(point);
+        bool inbox = false;
+        for(auto const& lineRect: lineBoundingRects) {
+            auto rect = lineRect.translated(geometry.leftDisplay(), geometry.topDisplay());
+            rect = rect.marginsAdded(QMargins(margin, margin, margin, margin));
+            if(rect.contains(point)) {
+                inbox = true;
+            }
+        }
+        return inbox;
+    };
+
+    // united rects of the lines, in the untransformed coordinates of the box
+    QRectF boundingRect(BoxGeometry const& geometry) const {
+        QRectF bounding;
+        for(auto const& lineRect: lineBoundingRects) {
+            bounding |= lineRect.translated(geometry.leftDisplay(), geometry.topDisplay());
+        }
+        return bounding;
     }
 };
 
+// Results of drawing a box which are needed afterwards, e.g. for hit tests.
+// They are returned by drawContent and kept by the caller, one per painted box.
+struct BoxRenderOutput {
+    // lines of text boxes, relative to the top left corner of the box
+    TextBoundings textBoundings;
+    // visible part of an image, in untransformed slide coordinates
+    std::optional<QRect> imageBoundingRect;
+};
+
+// render outputs of the boxes by box id
+using BoxRenderOutputs = std::unordered_map<QString, BoxRenderOutput>;
+
 class Box
 {
 public:
@@ -200,16 +296,27 @@ public:
     using List = std::vector<Ptr>;
     using Properties = std::unordered_map<QString, PropertyEntry>;
 
-    // Implement this in child classes to draw the box's contents given the passed @p variables
-    virtual void drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) = 0;
-    void drawManipulationSlide(QPainter& painter, int size);
+    // Implement this in child classes to draw the box's contents given the passed @p variables.
+    // Drawing does not change the box, so it can be drawn by several painters at once.
+    virtual BoxRenderOutput drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) const = 0;
+    void drawManipulationSlide(QPainter& painter, int size) const;
     // e.g. Border, background
-    void drawGlobalBoxSettings(QPainter& painter);
+    void drawGlobalBoxSettings(QPainter& painter) const;
 
     virtual std::shared_ptr<Box> clone() = 0;
 
-    // override this if the selectable area should be another than the boxGeometry
-    virtual bool containsPoint(QPoint point, int margin) const;
+    // override this if the selectable area should be another than the boxGeometry,
+    // output is the result of the last drawContent
+    virtual bool containsPoint(QPoint point, int margin, BoxRenderOutput const& output) const;
+    // area drawContent painted on, in untransformed slide coordinates
+    virtual QRect paintedRect(BoxRenderOutput const& output) const;
+
+    // writes everything drawContent depends on besides the context and external resources,
+    // boxes with equal fingerprints look the same
+    virtual void writeFingerprint(QDataStream& stream, PresentationContext const& context) const;
+    // writes the state of the external resources drawContent depends on, e.g. the modification time of a file.
+    // They change without the box, so unlike writeFingerprint it is called every time a fingerprint is read.
+    virtual void writeResourceFingerprint(QDataStream& stream, PresentationContext const& context) const;
 
     BoxStyle const& style() const;
     BoxGeometry const& geometry() const;
@@ -253,7 +360,7 @@ protected:
     QString substituteVariables(QString text, std::map<QString, QString> variables) const;
 
     struct PainterTransformScope {
-        PainterTransformScope(Box* self, QPainter& painter)
+        PainterTransformScope(Box const* self, QPainter& painter)
             : mSelf(self)
             , mPainter(painter)
         {
@@ -263,14 +370,14 @@ protected:
             mSelf->endDraw(mPainter);
         }
     private:
-        Box* mSelf;
+        Box const* mSelf;
         QPainter& mPainter;
     };
 
     BoxStyle mStyle;
 
 private:
-    void startDraw(QPainter& painter);
+    void startDraw(QPainter& painter) const;
     void endDraw(QPainter& painter) const;
 
 private:
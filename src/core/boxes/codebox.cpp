@@ -12,8 +12,9 @@ std::shared_ptr<Box> CodeBox::clone() {
     return std::make_shared<CodeBox>(*this);
 }
 
-void CodeBox::drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints) {
+BoxRenderOutput CodeBox::drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints) const {
     PainterTransformScope scope(this, painter);
+    BoxRenderOutput output;
     drawGlobalBoxSettings(painter);
 
     auto const text = substituteVariables(style().text(), context.mVariables);
@@ -39,12 +40,13 @@ void CodeBox::drawContent(QPainter& painter, PresentationContext const& context,
         QTextLine line = textLayout.createLine();
         line.setLineWidth(style().paintableRect().width());
         line.setPosition(QPointF(0, y));
-        mTextBoundings.lineBoundingRects.push_back(line.naturalTextRect());
+        output.textBoundings.lineBoundingRects.push_back(line.naturalTextRect());
         y += linespacing;
         textLayout.endLayout();
 
         textLayout.draw(&painter, style().paintableRect().topLeft());
         lineNumber++;
     }
+    return output;
 }
 
@@ -13,7 +13,7 @@ class CodeBox : public TextBox
 {
 public:
     std::shared_ptr<Box> clone() override;
-    void drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) override;
+    BoxRenderOutput drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) const override;
 };
 
 #endif // CODEBOX_H
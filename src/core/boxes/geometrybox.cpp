@@ -85,17 +85,20 @@ std::shared_ptr<Box> GeometryBox::clone() {
     return std::make_shared<GeometryBox>(*this);
 }
 
-void GeometryBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints){
-    auto const rect = style().paintableRect();
-    mPainterPath = painterPath(style().text(), rect);
+BoxRenderOutput GeometryBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) const {
     PainterTransformScope scope(this, painter);
     drawGlobalBoxSettings(painter);
     painter.setRenderHint(QPainter::Antialiasing);
     painter.setBrush(mStyle.color());
-    painter.drawPath(mPainterPath);
+    painter.drawPath(shapePath());
+    return {};
 }
 
-bool GeometryBox::containsPoint(QPoint point, int) const {
-    return mPainterPath.contains(geometry().transform().inverted().map(point));
+bool GeometryBox::containsPoint(QPoint point, int, BoxRenderOutput const&) const {
+    return shapePath().contains(geometry().transform().inverted().map(point));
+}
+
+QPainterPath GeometryBox::shapePath() const {
+    return painterPath(style().text(), style().paintableRect());
 }
 
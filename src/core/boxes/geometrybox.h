@@ -16,14 +16,13 @@ class GeometryBox : public Box
 public:
     GeometryBox() = default;
 
-    void drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) override;
-    bool containsPoint(QPoint point, int) const override;
+    BoxRenderOutput drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) const override;
+    bool containsPoint(QPoint point, int, BoxRenderOutput const&) const override;
 
     std::shared_ptr<Box> clone() override;
 
 private:
-    // ths shape is set when constructed,
-    // the path changes by every redraw and is saved for the function containsPoint
-    QPainterPath mPainterPath;
+    // the shape is set when constructed, the path depends on the geometry
+    QPainterPath shapePath() const;
 };
 #endif // GEOMETRYBOX_H
@@ -6,14 +6,19 @@
 
 #include "imagebox.h"
 #include "cachemanager.h"
+#include "imageresampler.h"
+#include "imagefileembedder.h"
 
 #include <filesystem>
 #include <string>
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QProcess>
 #include <QDebug>
 #include <QTemporaryFile>
 #include <QDir>
+#include <QImageReader>
 
 namespace  {
 QRect boundingBox(QSize const& imageSize, QRect const& boxRect) {
@@ -38,39 +43,41 @@ std::shared_ptr<Box> ImageBox::clone() {
     return std::make_shared<ImageBox>(*this);
 }
 
-void ImageBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints){
+BoxRenderOutput ImageBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) const {
     PainterTransformScope scope(this, painter);
     drawGlobalBoxSettings(painter);
-    auto path = substituteVariables(style().text(), context.mVariables);
-    if(!QDir::isAbsolutePath(path) && context.mVariables.find("%{resourcepath}") != context.mVariables.end()) {
-        path = absolutePath(path, context);
-    }
-    mImagePath = path;
+    auto const path = ImagePath(context);
     auto const fileInfo = QFileInfo(path);
+    BoxRenderOutput output;
     if(fileInfo.suffix() == "svg"){
         if(hints & PresentationRenderHints::TargetIsVectorSurface) {
             auto svg = QSvgRenderer(path);
             svg.setAspectRatioMode(Qt::KeepAspectRatio);
             svg.render(&painter, geometry().rect());
+            output.imageBoundingRect = geometry().rect();
         }
         else {
-            drawPixmap(loadSvg(path, geometry().size()), painter);
+            output.imageBoundingRect = drawPixmap(loadSvg(path, geometry().size()), painter);
         }
     }
     else{
         if(hints & PresentationRenderHints::TargetIsVectorSurface) {
-            auto image = QImage(path);
-            painter.drawImage(boundingBox(image.size(), geometry().rect()), image);
+            auto const [image, size] = loadExportImage(path, context.mMaximalImageResolution, context.mImageFileEmbedder);
+            output.imageBoundingRect = boundingBox(size, geometry().rect());
+            painter.drawImage(*output.imageBoundingRect, image);
         }
         else {
-            drawPixmap(loadImage(path, geometry().size()), painter);
+            output.imageBoundingRect = drawPixmap(loadImage(path, geometry().size()), painter);
         }
     }
+    return output;
 }
 
 PixMapElement ImageBox::loadImage(QString path, QSize size) const {
     auto pixmapVector = CacheManager<PixMapVector>::instance().getData(path);
-    if(pixmapVector.data && pixmapVector.data->findPixMap(size).mPixmap) {
+    auto const hit = pixmapVector.data && pixmapVector.data->findPixMap(size).mPixmap;
+    CacheManager<PixMapVector>::instance().countLookup(hit);
+    if(hit) {
         return pixmapVector.data->findPixMap(size);
     }
     if(pixmapVector.status == FileLoadStatus::failed){
@@ -81,8 +88,8 @@ PixMapElement ImageBox::loadImage(QString path, QSize size) const {
     newPixmap->fill(Qt::transparent);
     QPainter painter(newPixmap.get());
 
-    auto const image = QPixmap(path);
-    auto const paintImage = image.scaled(geometry().size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    auto const image = QImage(path);
+    auto const paintImage = QPixmap::fromImage(downscaleImage(image, image.size().scaled(geometry().size(), Qt::KeepAspectRatio)));
     auto const source = paintImage.size();
     auto const x = (geometry().widthDisplay() - source.width()) / 2;
     auto const y = (geometry().heightDisplay() - source.height()) / 2;
@@ -98,9 +105,56 @@ PixMapElement ImageBox::loadImage(QString path, QSize size) const {
     return {newPixmap, boundingBox};
 }
 
+std::pair<QImage, QSize> ImageBox::loadExportImage(QString path, double maximalResolution, ImageFileEmbedder* embedder) const {
+    QImageReader reader(path);
+    auto const fileSize = reader.size();
+    auto const readFile = [&reader, &path, embedder]() -> std::pair<QImage, QSize> {
+        // files placed without resampling are embedded unchanged
+        if(embedder) {
+            if(auto const placeholder = embedder->placeholder(path)) {
+                return {*placeholder, reader.size()};
+            }
+        }
+        auto const image = reader.read();
+        return {image, image.size()};
+    };
+    if(maximalResolution <= 0 || !fileSize.isValid()) {
+        return readFile();
+    }
+    auto const onPageSize = boundingBox(fileSize, geometry().rect()).size();
+    auto const size = fileSize.scaled((QSizeF(onPageSize) * maximalResolution).toSize(), Qt::KeepAspectRatio);
+    if(size.width() >= fileSize.width() || size.isEmpty()) {
+        return readFile();
+    }
+
+    auto images = CacheManager<ImageVector>::instance().getData(path);
+    auto const cached = images.data ? images.data->findImage(size) : std::nullopt;
+    CacheManager<ImageVector>::instance().countLookup(cached.has_value());
+    if(cached) {
+        return {*cached, size};
+    }
+    auto const image = reader.read();
+    if(image.isNull()) {
+        return {image, image.size()};
+    }
+    auto scaled = downscaleImage(image, size);
+    // opaque images are written without an alpha mask
+    if(!image.hasAlphaChannel()) {
+        scaled = scaled.convertToFormat(QImage::Format_RGB32);
+    }
+    if(!images.data) {
+        images.data = std::make_shared<ImageVector>();
+    }
+    images.data->insertImage(scaled);
+    CacheManager<ImageVector>::instance().setData(path, images.data);
+    return {scaled, size};
+}
+
 PixMapElement ImageBox::loadSvg(QString path, QSize size) const {
     auto pixmapVector = CacheManager<PixMapVector>::instance().getData(path);
-    if(pixmapVector.data && pixmapVector.data->findPixMap(size).mPixmap) {
+    auto const hit = pixmapVector.data && pixmapVector.data->findPixMap(size).mPixmap;
+    CacheManager<PixMapVector>::instance().countLookup(hit);
+    if(hit) {
         return pixmapVector.data->findPixMap(size);
     }
     if(pixmapVector.status == FileLoadStatus::failed){
@@ -163,22 +217,30 @@ std::shared_ptr<QSvgRenderer> ImageBox::loadPdf(QString path) const{
     return svg;
 }
 
-void ImageBox::drawPixmap(PixMapElement pixmapElement, QPainter& painter) {
+QRect ImageBox::drawPixmap(PixMapElement pixmapElement, QPainter& painter) const {
     PainterTransformScope scope(this, painter);
     drawGlobalBoxSettings(painter);
     if(!pixmapElement.mPixmap){
-        mBoundingBox = geometry().rect();
-        return;
+        return geometry().rect();
     }
     painter.drawPixmap(geometry().rect(), *pixmapElement.mPixmap, {{0, 0}, pixmapElement.mPixmap->size()});
-    mBoundingBox = pixmapElement.mBoundingBox;
-    mBoundingBox.translate(geometry().topLeft());
+    return pixmapElement.mBoundingBox.translated(geometry().topLeft());
 }
 
-bool ImageBox::containsPoint(QPoint point, int) const {
-    return mBoundingBox.contains(geometry().transform().inverted().map(point));
+bool ImageBox::containsPoint(QPoint point, int, BoxRenderOutput const& output) const {
+    // the whole box is selectable as long as the image is not drawn
+    return output.imageBoundingRect.value_or(geometry().rect()).contains(geometry().transform().inverted().map(point));
 }
 
-QString ImageBox::ImagePath() const{
-    return mImagePath;
+void ImageBox::writeResourceFingerprint(QDataStream& stream, PresentationContext const& context) const {
+    auto const fileInfo = QFileInfo(ImagePath(context));
+    stream << fileInfo.lastModified() << fileInfo.size();
+}
+
+QString ImageBox::ImagePath(PresentationContext const& context) const{
+    auto path = substituteVariables(style().text(), context.mVariables);
+    if(!QDir::isAbsolutePath(path) && context.mVariables.find("%{resourcepath}") != context.mVariables.end()) {
+        path = absolutePath(path, context);
+    }
+    return path;
 }
@@ -16,22 +16,25 @@ class ImageBox: public Box
 public:
     ImageBox() = default;
 
-    void drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) override;
-    bool containsPoint(QPoint point, int) const override;
+    BoxRenderOutput drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) const override;
+    bool containsPoint(QPoint point, int, BoxRenderOutput const& output) const override;
+    // includes the modification time of the image file
+    void writeResourceFingerprint(QDataStream& stream, PresentationContext const& context) const override;
 
     std::shared_ptr<Box> clone() override;
 
-    QString ImagePath() const;
+    // path of the image with the variables of the slide substituted
+    QString ImagePath(PresentationContext const& context) const;
 
 private:
     PixMapElement loadImage(QString path, QSize size) const;
     PixMapElement loadSvg(QString path, QSize size) const;
+    // the image of path for vector surfaces and the size of the file, the image is downsampled if it
+    // has more than maximalResolution pixels per slide unit or the placeholder of embedder for the file
+    std::pair<QImage, QSize> loadExportImage(QString path, double maximalResolution, ImageFileEmbedder* embedder) const;
     std::shared_ptr<QSvgRenderer> loadPdf(QString path) const;
-    void drawPixmap(PixMapElement pixmapElement, QPainter& painter);
-
-private:
-    QString mImagePath;
-    QRect mBoundingBox;
+    // returns the visible part of the image
+    QRect drawPixmap(PixMapElement pixmapElement, QPainter& painter) const;
 };
 
 #endif // PICTURE_H
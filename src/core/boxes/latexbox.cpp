@@ -12,7 +12,7 @@ std::shared_ptr<Box> LaTeXBox::clone() {
     return std::make_shared<LaTeXBox>(*this);
 }
 
-void LaTeXBox::drawContent(QPainter &painter, const PresentationContext &context, PresentationRenderHints hints) {
+BoxRenderOutput LaTeXBox::drawContent(QPainter &painter, const PresentationContext &context, PresentationRenderHints hints) const {
     auto additionalPreamble = QString();
     // scale factor for geometry of the box
     // physical length of document: 20cm, number of pixels: 1600
@@ -31,10 +31,6 @@ void LaTeXBox::drawContent(QPainter &painter, const PresentationContext &context
             "\\begin{document}\\textcolor{fontColor}{"
             + style().text() +
             "}\\end{document}";
-    QFile f("/tmp/test.tex");
-    f.open(QIODevice::WriteOnly);
-    f.write(latexInput.toUtf8());
-
     auto latex = cacheManager().getCachedImage(latexInput);
     PainterTransformScope scope(this, painter);
     drawGlobalBoxSettings(painter);
@@ -42,27 +38,28 @@ void LaTeXBox::drawContent(QPainter &painter, const PresentationContext &context
     switch(latex.status){
     case SvgStatus::Error: {
         painter.drawText(style().paintableRect(), "Latex Error");
-        return;
+        return {};
     }
     case SvgStatus::NotStarted:
         if(hints & PresentationRenderHints::NoPreviewRendering) {
             cacheManager().startConversionProcess(latexInput, ConversionType::BreakUntillFinished);
             latex = cacheManager().getCachedImage(latexInput);
             if(latex.status == Error) {
-                return;
+                return {};
             }
             break;
         }
         else {
             cacheManager().startConversionProcess(latexInput);
-            return;
+            return {};
         }
     case SvgStatus::Pending:
-        return;
+        return {};
     case SvgStatus::Success:
         break;
     }
     latex.svg->setAspectRatioMode(Qt::KeepAspectRatio);
     latex.svg->render(&painter, style().paintableRect());
+    return {};
 }
 
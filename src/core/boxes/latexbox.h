@@ -15,7 +15,7 @@ public:
     LaTeXBox() = default;
 
     std::shared_ptr<Box> clone() override;
-    void drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) override;
+    BoxRenderOutput drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) const override;
 };
 
 #endif // LATEXBOX_H
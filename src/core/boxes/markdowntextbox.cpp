@@ -26,7 +26,7 @@ std::shared_ptr<Box> MarkdownTextBox::clone() {
     return std::make_shared<MarkdownTextBox>(*this);
 }
 
-void MarkdownTextBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) {
+BoxRenderOutput MarkdownTextBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) const {
     PainterTransformScope scope(this, painter);
     drawGlobalBoxSettings(painter);
     auto text = substituteVariables(style().text(), context.mVariables);
@@ -49,7 +49,7 @@ void MarkdownTextBox::drawContent(QPainter& painter, const PresentationContext &
     }
     auto walker = antlr4::tree::ParseTreeWalker();
     walker.walk(&listener, tree);
-    mTextBoundings = listener.textBoundings();
+    return {listener.textBoundings(), {}};
 }
 
 
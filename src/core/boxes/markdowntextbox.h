@@ -17,7 +17,7 @@ public:
     MarkdownTextBox() = default;
 
     std::shared_ptr<Box> clone() override;
-    void drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) override;
+    BoxRenderOutput drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) const override;
 };
 
 #endif // TEXTFIELD_H
@@ -13,8 +13,9 @@ std::shared_ptr<Box> PlainTextBox::clone() {
     return std::make_shared<PlainTextBox>(*this);
 }
 
-void PlainTextBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) {
+BoxRenderOutput PlainTextBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) const {
     PainterTransformScope scope(this, painter);
+    BoxRenderOutput output;
     drawGlobalBoxSettings(painter);
 
     auto const text = substituteVariables(style().text(), context.mVariables);
@@ -35,10 +36,11 @@ void PlainTextBox::drawContent(QPainter& painter, const PresentationContext &con
             }
             line.setLineWidth(style().paintableRect().width());
             line.setPosition(QPointF(0, y));
-            mTextBoundings.lineBoundingRects.push_back(line.naturalTextRect());
+            output.textBoundings.lineBoundingRects.push_back(line.naturalTextRect());
             y += linespacing;
         }
         textLayout.endLayout();
         textLayout.draw(&painter, style().paintableRect().topLeft());
     }
+    return output;
 }
@@ -17,7 +17,7 @@ public:
     PlainTextBox() = default;
 
     std::shared_ptr<Box> clone() override;
-    void drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) override;
+    BoxRenderOutput drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) const override;
 };
 
 #endif // PLAINTEXTBOX_H
@@ -18,7 +18,7 @@ std::shared_ptr<Box> SectionPreviewBox::clone() {
     return std::make_shared<SectionPreviewBox>(*this);
 }
 
-void SectionPreviewBox::drawContent(QPainter &painter, const PresentationContext &context, PresentationRenderHints hints) {
+BoxRenderOutput SectionPreviewBox::drawContent(QPainter &painter, const PresentationContext &context, PresentationRenderHints hints) const {
     PainterTransformScope scope(this, painter);
     drawGlobalBoxSettings(painter);
 
@@ -63,4 +63,5 @@ void SectionPreviewBox::drawContent(QPainter &painter, const PresentationContext
         startText += {painter.fontMetrics().horizontalAdvance(section.name) +
                 20 * painter.fontMetrics().horizontalAdvance(" "), 0};
     }
+    return {};
 }
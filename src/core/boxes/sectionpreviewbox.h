@@ -10,7 +10,7 @@ public:
 
     std::shared_ptr<Box> clone() override;
 
-    void drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) override;
+    BoxRenderOutput drawContent(QPainter& painter, PresentationContext const& context, PresentationRenderHints hints = PresentationRenderHints::NoRenderHints) const override;
 };
 
 #endif // SECTIONPREVIEWBOX_H
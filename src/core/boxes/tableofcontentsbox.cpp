@@ -15,8 +15,9 @@ std::shared_ptr<Box> TableofContentsBox::clone() {
     return std::make_shared<TableofContentsBox>(*this);
 }
 
-void TableofContentsBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) {
+BoxRenderOutput TableofContentsBox::drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) const {
     PainterTransformScope scope(this, painter);
+    BoxRenderOutput output;
     drawGlobalBoxSettings(painter);
 
     auto startLine = QPointF(0, 0);
@@ -44,7 +45,7 @@ void TableofContentsBox::drawContent(QPainter& painter, const PresentationContex
         drawItemMarker(painter, startLine);
         painter.restore();
 
-        drawEntry(painter, startLine, section.name);
+        drawEntry(painter, startLine, section.name, output.textBoundings);
 
         for(auto const& subsection: section.subsection) {
             startLine.setX(painter.fontMetrics().xHeight() * 6.0);
@@ -55,13 +56,14 @@ void TableofContentsBox::drawContent(QPainter& painter, const PresentationContex
                 painter.setOpacity(0.5);
             }
             drawItemMarker(painter, startLine);
-            drawEntry(painter, startLine, subsection.name);
+            drawEntry(painter, startLine, subsection.name, output.textBoundings);
         }
         startLine += {0, linespacing * 0.25};
     }
+    return output;
 }
 
-void TableofContentsBox::drawEntry(QPainter& painter, QPointF &startOfLine, const QString &section) {
+void TableofContentsBox::drawEntry(QPainter& painter, QPointF &startOfLine, const QString &section, TextBoundings& textBoundings) const {
     auto const linespacing = painter.fontMetrics().leading() + style().linespacing() * painter.fontMetrics().lineSpacing();
     QTextLayout textLayout(section);
     textLayout.setFont(painter.font());
@@ -74,14 +76,14 @@ void TableofContentsBox::drawEntry(QPainter& painter, QPointF &startOfLine, cons
         }
         line.setLineWidth(style().paintableRect().width());
         line.setPosition(startOfLine);
-        mTextBoundings.lineBoundingRects.push_back(line.naturalTextRect());
+        textBoundings.lineBoundingRects.push_back(line.naturalTextRect());
         startOfLine += {0, linespacing};
     }
     textLayout.endLayout();
     textLayout.draw(&painter, style().paintableRect().topLeft());
 }
 
-void TableofContentsBox::drawItemMarker(QPainter &painter, QPointF & startofLine) {
+void TableofContentsBox::drawItemMarker(QPainter &painter, QPointF & startofLine) const {
     auto const markerSize = painter.fontMetrics().xHeight() * 0.25;
     auto middleItem = startofLine;
     middleItem += {0,  painter.fontMetrics().height() * 0.5};
@@ -9,11 +9,11 @@ public:
     TableofContentsBox() = default;
 
     std::shared_ptr<Box> clone() override;
-    void drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) override;
+    BoxRenderOutput drawContent(QPainter& painter, const PresentationContext &context, PresentationRenderHints hints) const override;
 
 private:
-    void drawEntry(QPainter &painter, QPointF& startOfLine, QString const& section);
-    void drawItemMarker(QPainter &painter, QPointF & startofLine);
+    void drawEntry(QPainter &painter, QPointF& startOfLine, QString const& section, TextBoundings& textBoundings) const;
+    void drawItemMarker(QPainter &painter, QPointF & startofLine) const;
 };
 
 #endif // TABLEOFCONTENTSBOX_H
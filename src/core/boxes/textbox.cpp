@@ -7,11 +7,16 @@
 #include "textbox.h"
 
 
-bool TextBox::containsPoint(QPoint point, int margin) const {
+bool TextBox::containsPoint(QPoint point, int margin, BoxRenderOutput const& output) const {
     if(text().isEmpty()) {
         return geometry().rect().contains(point);
     }
-    return mTextBoundings.contains(point, margin, geometry());
+    return output.textBoundings.contains(point, margin, geometry());
+}
+
+QRect TextBox::paintedRect(BoxRenderOutput const& output) const {
+    // text can overflow the box
+    return geometry().rect() | output.textBoundings.boundingRect(geometry()).toAlignedRect();
 }
 
 void TextBox::appendText(QString const& text) {
@@ -9,34 +9,15 @@
 
 #include <box.h>
 
-struct TextBoundings {
-    std::vector<QRectF> lineBoundingRects;
-
-    bool contains(QPoint point, int margin, BoxGeometry geometry) const {
-        point = geometry.transform().inverted().map(point);
-        bool inbox = false;
-        for(auto const& lineRect: lineBoundingRects) {
-            auto rect = lineRect.translated(geometry.leftDisplay(), geometry.topDisplay());
-            rect = rect.marginsAdded(QMargins(margin, margin, margin, margin));
-            if(rect.contains(point)) {
-                inbox = true;
-            }
-        }
-        return inbox;
-    };
-};
-
 class TextBox : public Box
 {
 public:
 
-    bool containsPoint(QPoint point, int margin) const override;
+    bool containsPoint(QPoint point, int margin, BoxRenderOutput const& output) const override;
+    QRect paintedRect(BoxRenderOutput const& output) const override;
 
     void appendText(QString const& text);
     const QString text() const;
-
-protected:
-    TextBoundings mTextBoundings;
 };
 
 #endif // TEXTBOX_H
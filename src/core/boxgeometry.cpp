@@ -108,7 +108,7 @@ void BoxGeometry::setHeight(int height) {
 }
 
 void BoxGeometry::addAngle(qreal dAngle) {
-    mAngle = mAngle.value() +  dAngle;
+    mAngle = angleDisplay() +  dAngle;
     mAngle = int(mAngle.value()) % 360;
 }
 
@@ -165,7 +165,7 @@ QTransform BoxGeometry::transform() const {
 QTransform BoxGeometry::transform(QPoint rotatingPoint) const {
     QTransform transform;
     transform.translate(rotatingPoint.x(), rotatingPoint.y());
-    transform.rotate(mAngle.value());
+    transform.rotate(angleDisplay());
     transform.translate(-rotatingPoint.x(), -rotatingPoint.y());
     return transform;
 }
@@ -173,7 +173,7 @@ QTransform BoxGeometry::transform(QPoint rotatingPoint) const {
 QTransform BoxGeometry::transform(QPointF rotatingPoint) const {
     QTransform transform;
     transform.translate(rotatingPoint.x(), rotatingPoint.y());
-    transform.rotate(mAngle.value());
+    transform.rotate(angleDisplay());
     transform.translate(-rotatingPoint.x(), -rotatingPoint.y());
     return transform;
 
@@ -181,7 +181,7 @@ QTransform BoxGeometry::transform(QPointF rotatingPoint) const {
 
 QTransform BoxGeometry::rotateTransform() const {
     QTransform transform;
-    transform.rotate(mAngle.value());
+    transform.rotate(angleDisplay());
     return transform;
 }
 
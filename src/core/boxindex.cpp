@@ -0,0 +1,46 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "boxindex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// in slide coordinates, a standard slide of 1600x900 has 16x9 cells
+constexpr int cellSize = 100;
+}
+
+BoxIndex::BoxIndex(Box::List const& boxes, BoxRenderOutputs const& renderOutputs, QSize slideSize, int margin)
+    : mColumns(std::max(1, (slideSize.width() + cellSize - 1) / cellSize))
+    , mRows(std::max(1, (slideSize.height() + cellSize - 1) / cellSize))
+    , mCells(mColumns * mRows)
+{
+    for(int index = 0; index < int(boxes.size()); index++) {
+        auto const& box = boxes[index];
+        auto const output = renderOutputs.find(box->id());
+        auto const painted = output == renderOutputs.end() ? box->paintedRect({}) : box->paintedRect(output->second);
+        auto const rect = QRectF(painted.marginsAdded({margin, margin, margin, margin}));
+        auto const bounding = box->geometry().transform().map(QPolygonF(rect)).boundingRect();
+        // boxes outside of the slide are put into the cells at the border
+        auto const clampColumn = [this](double x){return std::clamp(int(std::floor(x / cellSize)), 0, mColumns - 1);};
+        auto const clampRow = [this](double y){return std::clamp(int(std::floor(y / cellSize)), 0, mRows - 1);};
+        for(int row = clampRow(bounding.top()); row <= clampRow(bounding.bottom()); row++) {
+            for(int column = clampColumn(bounding.left()); column <= clampColumn(bounding.right()); column++) {
+                mCells[cell(column, row)].push_back(index);
+            }
+        }
+    }
+}
+
+std::vector<int> const& BoxIndex::candidates(QPoint point) const {
+    auto const column = std::clamp(int(std::floor(double(point.x()) / cellSize)), 0, mColumns - 1);
+    auto const row = std::clamp(int(std::floor(double(point.y()) / cellSize)), 0, mRows - 1);
+    return mCells[cell(column, row)];
+}
+
+int BoxIndex::cell(int column, int row) const {
+    return row * mColumns + column;
+}
@@ -0,0 +1,33 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#pragma once
+
+#include <QSize>
+#include <vector>
+#include "box.h"
+
+// Uniform grid over the transformed bounding rects of the boxes of a slide.
+// Hit tests only run the exact Box::containsPoint on the boxes of the cell under the point.
+// The index has to be rebuilt when the geometry of a box changes.
+class BoxIndex
+{
+public:
+    // margin is added to the bounding rect of every box, e.g. for the manipulation frame.
+    // renderOutputs are the outputs of the last paint of the boxes.
+    BoxIndex(Box::List const& boxes, BoxRenderOutputs const& renderOutputs, QSize slideSize, int margin);
+
+    // indices of the boxes whose bounding rect may contain the point, in the order of the boxes
+    std::vector<int> const& candidates(QPoint point) const;
+
+private:
+    int cell(int column, int row) const;
+
+private:
+    int mColumns;
+    int mRows;
+    std::vector<std::vector<int>> mCells;
+};
@@ -0,0 +1,82 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "boxindextest.h"
+#include "boxindex.h"
+#include "geometrybox.h"
+
+QTEST_GUILESS_MAIN(BoxIndexTest)
+
+namespace {
+auto const slideSize = QSize(1600, 900);
+
+Box::Ptr createBox(QString const& id, QRect rect, double angle = 0) {
+    auto box = std::make_shared<GeometryBox>();
+    box->setId(id);
+    box->setGeometry(BoxGeometry(rect, angle));
+    return box;
+}
+
+bool isCandidate(BoxIndex const& index, QPoint point, int box) {
+    auto const& candidates = index.candidates(point);
+    return std::find(candidates.begin(), candidates.end(), box) != candidates.end();
+}
+}
+
+void BoxIndexTest::testBoxSpanningCells() {
+    auto const boxes = Box::List{createBox("wide", QRect(150, 50, 500, 60)), createBox("small", QRect(420, 20, 30, 30))};
+    BoxIndex index(boxes, {}, slideSize, 0);
+    for(auto const x : {160, 320, 640}) {
+        QVERIFY(isCandidate(index, {x, 80}, 0));
+    }
+    QVERIFY(!isCandidate(index, {60, 80}, 0));
+    QVERIFY(!isCandidate(index, {760, 80}, 0));
+    QVERIFY(!isCandidate(index, {320, 250}, 0));
+    // the candidates of a cell keep the order of the boxes
+    QCOMPARE(index.candidates({430, 30}), std::vector<int>({0, 1}));
+
+    // the margin reaches into the neighbouring cells
+    BoxIndex indexWithMargin(boxes, {}, slideSize, 100);
+    QVERIFY(isCandidate(indexWithMargin, {60, 80}, 0));
+    QVERIFY(isCandidate(indexWithMargin, {320, 250}, 0));
+}
+
+void BoxIndexTest::testNegativeCoordinates() {
+    auto const boxes = Box::List{createBox("outside", QRect(-300, -200, 150, 100)), createBox("border", QRect(-50, 850, 200, 200))};
+    BoxIndex index(boxes, {}, slideSize, 0);
+    // boxes outside of the slide are in the cells at the border, points outside are clamped the same way
+    QVERIFY(isCandidate(index, {-250, -150}, 0));
+    QVERIFY(isCandidate(index, {10, 10}, 0));
+    QVERIFY(!isCandidate(index, {150, 150}, 0));
+    QVERIFY(isCandidate(index, {-20, 1000}, 1));
+    QVERIFY(isCandidate(index, {120, 890}, 1));
+    QVERIFY(!isCandidate(index, {250, 890}, 1));
+    QVERIFY(!isCandidate(index, {-250, -150}, 1));
+}
+
+void BoxIndexTest::testRotatedBox() {
+    // rotated by 90 degrees around its center the box covers 700 to 900 horizontally and 100 to 800 vertically
+    auto const boxes = Box::List{createBox("rotated", QRect(450, 350, 700, 200), 90)};
+    BoxIndex index(boxes, {}, slideSize, 0);
+    QVERIFY(isCandidate(index, {800, 150}, 0));
+    QVERIFY(isCandidate(index, {800, 750}, 0));
+    QVERIFY(!isCandidate(index, {500, 450}, 0));
+    QVERIFY(!isCandidate(index, {1050, 450}, 0));
+}
+
+void BoxIndexTest::testRebuild() {
+    auto const boxes = Box::List{createBox("moved", QRect(100, 100, 50, 50))};
+    std::optional<BoxIndex> index;
+    index.emplace(boxes, BoxRenderOutputs{}, slideSize, 0);
+    QVERIFY(isCandidate(*index, {120, 120}, 0));
+
+    // the slide widget resets the index when a box moves and builds it again on the next hit test
+    boxes.front()->setGeometry(BoxGeometry(QRect(1200, 700, 50, 50), 0));
+    index.reset();
+    index.emplace(boxes, BoxRenderOutputs{}, slideSize, 0);
+    QVERIFY(!isCandidate(*index, {120, 120}, 0));
+    QVERIFY(isCandidate(*index, {1220, 720}, 0));
+}
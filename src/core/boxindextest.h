@@ -0,0 +1,22 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef BOXINDEXTEST_H
+#define BOXINDEXTEST_H
+
+#include <QtTest/QTest>
+
+class BoxIndexTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testBoxSpanningCells();
+    void testNegativeCoordinates();
+    void testRotatedBox();
+    void testRebuild();
+};
+
+#endif // BOXINDEXTEST_H
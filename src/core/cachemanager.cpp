@@ -107,6 +107,22 @@ void CacheManager<T>::deleteAllResources(){
     }
 }
 
+template <class T>
+void CacheManager<T>::countLookup(bool hit) {
+    if(hit) {
+        mHits++;
+    }
+    else {
+        mMisses++;
+    }
+}
+
+template <class T>
+CacheStatistics CacheManager<T>::statistics() const {
+    return {mHits, mMisses};
+}
+
 template class CacheManager<QSvgRenderer>;
 template class CacheManager<PixMapVector>;
 template class CacheManager<QPixmap>;
+template class CacheManager<ImageVector>;
@@ -15,8 +15,10 @@
 #include <QSvgRenderer>
 #include <QPixmap>
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <optional>
 #include <vector>
 
 enum FileLoadStatus{
@@ -49,6 +51,41 @@ struct PixMapVector {
     }
 };
 
+// images downsampled for exports, the most recently used first
+struct ImageVector {
+    std::vector<QImage> mImages;
+
+    void insertImage(QImage const& image) {
+        mImages.insert(mImages.begin(), image);
+        if(mImages.size() > 4) {
+            mImages.pop_back();
+        }
+    }
+
+    std::optional<QImage> findImage(QSize size) const {
+        for(auto const& image : mImages) {
+            if(image.size() == size) {
+                return image;
+            }
+        }
+        return {};
+    }
+};
+
+// lookups of a cache, e.g. for the performance overlay
+struct CacheStatistics {
+    qint64 hits = 0;
+    qint64 misses = 0;
+
+    qint64 lookups() const {
+        return hits + misses;
+    }
+    // share of the lookups that were hits, 0 without lookups
+    double hitRate() const {
+        return lookups() == 0 ? 0 : double(hits) / lookups();
+    }
+};
+
 template <class T>
 struct DataEntry{
     std::shared_ptr<T> data;
@@ -65,6 +102,9 @@ public:
     static CacheManager<T>& instance ();
     void deleteFile(QString const &path);
     void deleteAllResources();
+    // the cache does not know if an entry fits the request, the users count the lookups
+    void countLookup(bool hit);
+    CacheStatistics statistics() const;
 
 private:
     CacheManager();
@@ -80,6 +120,8 @@ private:
     std::function<void(QString)> mDataChangedCallback;
     QTimer mFileTimer;
     QTimer mDirTimer;
+    std::atomic<qint64> mHits = 0;
+    std::atomic<qint64> mMisses = 0;
 };
 
 #endif // IMAGECACHEMANAGER_H
@@ -8,8 +8,29 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QDir>
+#include <QtEndian>
 #include <set>
 
+namespace {
+constexpr char binaryMagic[4] = {'P', 'P', 'C', 'B'};
+constexpr char binarySuffix[] = "ppcb";
+constexpr quint16 binaryVersion = 1;
+constexpr qint64 headerSize = 16;
+constexpr qint64 recordSize = 32;
+
+template<typename T>
+void appendLittleEndian(QByteArray& data, T value) {
+    char buffer[sizeof(T)];
+    qToLittleEndian(value, buffer);
+    data.append(buffer, sizeof(T));
+}
+
+template<typename T>
+T readLittleEndian(uchar const* data) {
+    return qFromLittleEndian<T>(data);
+}
+}
+
 ConfigBoxes::ConfigBoxes(QString filename)
 {
     QFile file(filename);
@@ -17,6 +38,20 @@ ConfigBoxes::ConfigBoxes(QString filename)
         throw ConfigError{"Cannot open file", filename};
         return;
     }
+    if(file.peek(sizeof(binaryMagic)) == QByteArray(binaryMagic, sizeof(binaryMagic))) {
+        // map the file instead of copying it, the records are read in place
+        auto const size = file.size();
+        if(auto const data = file.map(0, size)) {
+            loadConfigFromBinary(data, size, filename);
+            file.unmap(data);
+        }
+        else {
+            auto const val = file.readAll();
+            loadConfigFromBinary(reinterpret_cast<uchar const*>(val.constData()), val.size(), filename);
+        }
+        mFormat = Format::Binary;
+        return;
+    }
     auto const val = file.readAll();
     auto doc = QJsonDocument::fromJson(val);
     loadConfigFromJson(doc);
@@ -58,13 +93,77 @@ void ConfigBoxes::loadConfigFromJson(QJsonDocument doc){
     }
 }
 
-void ConfigBoxes::saveConfig(QString filename) const
+void ConfigBoxes::loadConfigFromBinary(uchar const* data, qint64 size, QString const& filename) {
+    mConfigMap.clear();
+    if(size < headerSize || readLittleEndian<quint16>(data + 4) != binaryVersion) {
+        throw ConfigError{QObject::tr("Unsupported configuration format in file %1").arg(filename), filename};
+    }
+    auto const numberRecords = qint64(readLittleEndian<quint32>(data + 8));
+    auto const stringTableSize = qint64(readLittleEndian<quint32>(data + 12));
+    auto const stringTableOffset = headerSize + numberRecords * recordSize;
+    if(stringTableOffset + stringTableSize > size) {
+        throw ConfigError{QObject::tr("Configuration file %1 is truncated").arg(filename), filename};
+    }
+    auto const stringTable = data + stringTableOffset;
+    for(qint64 i = 0; i < numberRecords; i++) {
+        auto const record = data + headerSize + i * recordSize;
+        auto const idOffset = qint64(readLittleEndian<quint32>(record));
+        auto const idLength = qint64(readLittleEndian<quint32>(record + 4));
+        if(idOffset + idLength > stringTableSize) {
+            throw ConfigError{QObject::tr("Configuration file %1 is corrupted").arg(filename), filename};
+        }
+        auto const id = QString::fromUtf8(reinterpret_cast<char const*>(stringTable + idOffset), int(idLength));
+        auto const rect = QRect(readLittleEndian<qint32>(record + 8), readLittleEndian<qint32>(record + 12),
+                                readLittleEndian<qint32>(record + 16), readLittleEndian<qint32>(record + 20));
+        auto const angle = readLittleEndian<double>(record + 24);
+        mConfigMap[id] = {MemberBoxGeometry{angle, rect}};
+    }
+}
+
+QByteArray ConfigBoxes::toBinary() const {
+    QByteArray stringTable;
+    QByteArray data;
+    data.reserve(int(headerSize + qint64(mConfigMap.size()) * recordSize));
+    data.append(binaryMagic, sizeof(binaryMagic));
+    appendLittleEndian<quint16>(data, binaryVersion);
+    appendLittleEndian<quint16>(data, 0);
+    appendLittleEndian<quint32>(data, quint32(mConfigMap.size()));
+    // the size of the string table is known after all records are written
+    appendLittleEndian<quint32>(data, 0);
+    for(auto const& [id, config] : mConfigMap) {
+        auto const utf8Id = id.toUtf8();
+        auto const& rect = config.geometry.rect;
+        appendLittleEndian<quint32>(data, quint32(stringTable.size()));
+        appendLittleEndian<quint32>(data, quint32(utf8Id.size()));
+        appendLittleEndian<qint32>(data, rect.left());
+        appendLittleEndian<qint32>(data, rect.top());
+        appendLittleEndian<qint32>(data, rect.width());
+        appendLittleEndian<qint32>(data, rect.height());
+        appendLittleEndian<double>(data, config.geometry.angle);
+        stringTable.append(utf8Id);
+    }
+    qToLittleEndian(quint32(stringTable.size()), data.data() + 12);
+    data.append(stringTable);
+    return data;
+}
+
+void ConfigBoxes::saveConfig(QString filename) const {
+    // a .json file is always JSON, even if the configuration was loaded from a binary file
+    saveConfig(filename, QFileInfo(filename).suffix() == binarySuffix ? Format::Binary : Format::Json);
+}
+
+void ConfigBoxes::saveConfig(QString filename, Format format) const
 {
     QFile file(filename);
     if (!file.open(QIODevice::WriteOnly)) {
         throw ConfigError{QObject::tr("Cannot open file %1").arg(filename), filename};
         return;
     }
+    if(format == Format::Binary) {
+        file.write(toBinary());
+        file.close();
+        return;
+    }
     QJsonArray array;
     for(auto it = mConfigMap.begin(); it != mConfigMap.end(); it++) {
         QJsonObject item;
@@ -112,3 +211,28 @@ MemberBoxGeometry ConfigBoxes::getRect(QString id) const{
     }
     return {};
 }
+
+std::optional<MemberBoxGeometry> ConfigBoxes::findRect(QString const& id) const {
+    if(auto it = mConfigMap.find(id); it != mConfigMap.end()) {
+        return it->second.geometry;
+    }
+    return std::nullopt;
+}
+
+std::map<QString, JsonConfig> const& ConfigBoxes::entries() const {
+    return mConfigMap;
+}
+
+ConfigBoxes::Format ConfigBoxes::format() const {
+    return mFormat;
+}
+
+void convertConfig(QString const& source, QString const& destination, ConfigBoxes::Format format) {
+    ConfigBoxes const config(source);
+    config.saveConfig(destination, format);
+}
+
+QString configFileName(QString const& pathWithBaseName) {
+    auto const binary = pathWithBaseName + "." + binarySuffix;
+    return QFile::exists(binary) ? binary : pathWithBaseName + ".json";
+}
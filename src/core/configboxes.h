@@ -23,13 +23,30 @@ struct ConfigError{
     QString filename;
 };
 
+// The configuration is either stored as JSON or in a compact binary format.
+// JSON files have the extension .json, binary ones .ppcb.
+// The binary format consists of a header, fixed-size geometry records
+// and a table with the UTF-8 encoded box ids:
+//   header:  "PPCB", quint16 version, quint16 reserved, quint32 number of records, quint32 size of string table
+//   record:  quint32 id offset, quint32 id length, qint32 x, y, width, height, double angle
+// All values are little endian, the file can be read directly from a memory mapping.
 class ConfigBoxes
 {
 public:
+    enum class Format {
+        Json,
+        Binary
+    };
+
     ConfigBoxes() = default;
+    // detects the format of the file
     ConfigBoxes(QString filename);
 
+    // the format is chosen by the extension of filename
     void saveConfig(QString filename) const;
+    void saveConfig(QString filename, Format format) const;
+    // format of the loaded file
+    Format format() const;
 
     void addRect(const MemberBoxGeometry &rect, QString const& id);
     void deleteRect(QString id);
@@ -38,14 +55,26 @@ public:
     void deleteAllRectsExcept(std::vector<QString> const& boxIds);
 
     MemberBoxGeometry getRect(QString id) const;
+    // returns no value if the configuration has no entry for the box
+    std::optional<MemberBoxGeometry> findRect(QString const& id) const;
+    std::map<QString, JsonConfig> const& entries() const;
 
 private:
     void saveJsonConfigurations(QJsonObject &json, const JsonConfig config) const;
     JsonConfig readJsonConfigurations(const QJsonObject &json);
     void loadConfigFromJson(QJsonDocument doc);
+    void loadConfigFromBinary(uchar const* data, qint64 size, QString const& filename);
+    QByteArray toBinary() const;
 
 private:
     std::map<QString, JsonConfig> mConfigMap;
+    Format mFormat = Format::Json;
 };
 
+// converts a configuration file of any format to the given format, e.g. from JSON to binary
+void convertConfig(QString const& source, QString const& destination, ConfigBoxes::Format format);
+// configuration file of the presentation or template pathWithBaseName,
+// <pathWithBaseName>.ppcb if a binary configuration exists and <pathWithBaseName>.json otherwise
+QString configFileName(QString const& pathWithBaseName);
+
 #endif // CONFIGBOXES_H
@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "configboxestest.h"
+#include "configboxes.h"
+
+#include <QTemporaryDir>
+
+QTEST_GUILESS_MAIN(ConfigBoxesTest)
+Q_DECLARE_METATYPE(ConfigBoxes::Format)
+
+namespace {
+ConfigBoxes createConfig() {
+    ConfigBoxes config;
+    config.addRect({0, QRect(50, 60, 400, 300)}, "intern-0-0");
+    config.addRect({12.345678901234567, QRect(-20, 0, 1, 1)}, "title");
+    config.addRect({-90, QRect(1600, 900, 0, 0)}, QString::fromUtf8("böx-猫"));
+    return config;
+}
+
+void compareConfig(ConfigBoxes const& actual, ConfigBoxes const& expected) {
+    QCOMPARE(actual.entries().size(), expected.entries().size());
+    for(auto const& [id, config] : expected.entries()) {
+        auto const geometry = actual.findRect(id);
+        QVERIFY(geometry.has_value());
+        QCOMPARE(geometry->rect, config.geometry.rect);
+        QCOMPARE(geometry->angle, config.geometry.angle);
+    }
+}
+}
+
+void ConfigBoxesTest::testRoundTrip() {
+    QFETCH(ConfigBoxes::Format, first);
+    QFETCH(ConfigBoxes::Format, second);
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto const config = createConfig();
+    config.saveConfig(dir.filePath("first"), first);
+    convertConfig(dir.filePath("first"), dir.filePath("second"), second);
+    convertConfig(dir.filePath("second"), dir.filePath("third"), first);
+    compareConfig(ConfigBoxes(dir.filePath("second")), config);
+    compareConfig(ConfigBoxes(dir.filePath("third")), config);
+}
+
+void ConfigBoxesTest::testRoundTrip_data() {
+    QTest::addColumn<ConfigBoxes::Format>("first");
+    QTest::addColumn<ConfigBoxes::Format>("second");
+    QTest::newRow("json to binary") << ConfigBoxes::Format::Json << ConfigBoxes::Format::Binary;
+    QTest::newRow("binary to json") << ConfigBoxes::Format::Binary << ConfigBoxes::Format::Json;
+    QTest::newRow("binary to binary") << ConfigBoxes::Format::Binary << ConfigBoxes::Format::Binary;
+}
+
+void ConfigBoxesTest::testDetectFormat() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto const config = createConfig();
+    config.saveConfig(dir.filePath("config.json"), ConfigBoxes::Format::Binary);
+    auto const binary = ConfigBoxes(dir.filePath("config.json"));
+    QCOMPARE(binary.format(), ConfigBoxes::Format::Binary);
+    // the extension chooses the format when saving
+    binary.saveConfig(dir.filePath("saved.json"));
+    QCOMPARE(ConfigBoxes(dir.filePath("saved.json")).format(), ConfigBoxes::Format::Json);
+    binary.saveConfig(dir.filePath("saved.ppcb"));
+    QCOMPARE(ConfigBoxes(dir.filePath("saved.ppcb")).format(), ConfigBoxes::Format::Binary);
+
+    config.saveConfig(dir.filePath("config.json"), ConfigBoxes::Format::Json);
+    QCOMPARE(ConfigBoxes(dir.filePath("config.json")).format(), ConfigBoxes::Format::Json);
+
+    QFile empty(dir.filePath("empty.json"));
+    QVERIFY(empty.open(QIODevice::WriteOnly));
+    empty.close();
+    QVERIFY(ConfigBoxes(dir.filePath("empty.json")).entries().empty());
+}
+
+void ConfigBoxesTest::testTruncatedBinary() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    createConfig().saveConfig(dir.filePath("config.json"), ConfigBoxes::Format::Binary);
+    QFile file(dir.filePath("config.json"));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    file.resize(file.size() - 3);
+    file.close();
+    QVERIFY_EXCEPTION_THROWN(ConfigBoxes(dir.filePath("config.json")), ConfigError);
+}
@@ -0,0 +1,22 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef CONFIGBOXESTEST_H
+#define CONFIGBOXESTEST_H
+
+#include <QtTest/QTest>
+
+class ConfigBoxesTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testRoundTrip();
+    void testRoundTrip_data();
+    void testDetectFormat();
+    void testTruncatedBinary();
+};
+
+#endif // CONFIGBOXESTEST_H
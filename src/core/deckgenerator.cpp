@@ -0,0 +1,105 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "deckgenerator.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+
+namespace {
+
+QString templateText() {
+    return "\\setvar font-size 30\n"
+           "\n"
+           "\\slide[defineclass: default] default\n"
+           "\\geometry[color: #dddddd] rectangle\n"
+           "\\text[defineclass: title; font-size: 45]\n"
+           "\\text[defineclass: body]\n"
+           "\\text[defineclass: pagenumber; font-size: 20; text-align: right]\n"
+           "\\text[class: pagenumber] %{pagenumber} / %{totalpages}\n";
+}
+
+QString boxText(int slide, int box, DeckOptions const& options) {
+    auto const id = QString("s%1b%2").arg(slide).arg(box);
+    auto const variable = options.variables > 0 ? QString(" %{var%1}").arg((slide + box) % options.variables) : QString();
+    switch(box % 6) {
+    case 0:
+        return QString("\\body[id: %1]\n* An *item* with __emphasis__%2\n    * and a **subitem**\n* Force $F = ma$\n").arg(id, variable);
+    case 1:
+        return QString("\\code[id: %1; language: C++]\nint box%2() {\n    return %2;\n}\n").arg(id).arg(box);
+    case 2:
+        return QString("\\latex[id: %1] \\{$\\sum_{i=0}^{%2} i$\\}\n").arg(id).arg(box);
+    case 3:
+        return QString("\\geometry[id: %1; color: #4488cc] ellipse\n").arg(id);
+    case 4:
+        return QString("\\plaintext[id: %1] Plain text %2 on slide %3\n").arg(id).arg(box).arg(slide);
+    default:
+        return QString("\\text[id: %1; color: #444] Text %2 on slide %3%4\n").arg(id).arg(box).arg(slide).arg(variable);
+    }
+}
+}
+
+GeneratedDeck generateDeck(DeckOptions const& options) {
+    QRandomGenerator random(options.seed);
+    GeneratedDeck deck;
+    if(options.useTemplate) {
+        deck.text += QString("\\usetemplate %1\n").arg(generatedTemplateName);
+        deck.templateText = templateText();
+    }
+    for(int variable = 0; variable < options.variables; variable++) {
+        deck.text += QString("\\setvar var%1 value %1\n").arg(variable);
+    }
+    if(options.slidesPerSection > 0) {
+        deck.text += "\\setvar section Section 0\n";
+    }
+
+    for(int slide = 0; slide < options.slides; slide++) {
+        // sections and variables are set between two slides
+        if(slide > 0 && options.slidesPerSection > 0 && slide % options.slidesPerSection == 0) {
+            deck.text += QString("\\section Section %1\n").arg(slide / options.slidesPerSection);
+        }
+        deck.text += QString("\n\\slide slide%1\n\\title Slide %1\n").arg(slide);
+        for(int box = 0; box < options.boxesPerSlide; box++) {
+            deck.text += boxText(slide, box, options);
+            // only text boxes can be paused
+            if(box % 6 == 5 && random.generateDouble() < options.pauseDensity) {
+                deck.text += "\\pause and more\n";
+            }
+            if(box % 2 == 0) {
+                auto const rect = QRect(random.bounded(1200), random.bounded(600), 100 + random.bounded(300), 50 + random.bounded(200));
+                deck.configuration.addRect({double(random.bounded(360)), rect}, QString("s%1b%2").arg(slide).arg(box));
+            }
+        }
+    }
+    return deck;
+}
+
+bool writeDeck(GeneratedDeck const& deck, QString const& baseName) {
+    auto const write = [](QString const& fileName, QString const& text) {
+        QFile file(fileName);
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        auto const data = text.toUtf8();
+        return file.write(data) == data.size();
+    };
+    if(!write(baseName + ".potato", deck.text)) {
+        return false;
+    }
+    try {
+        deck.configuration.saveConfig(baseName + ".json");
+        if(!deck.templateText.isEmpty()) {
+            auto const templateName = QFileInfo(baseName).absolutePath() + "/" + generatedTemplateName;
+            if(!write(templateName + ".potato", deck.templateText)) {
+                return false;
+            }
+            deck.templateConfiguration.saveConfig(templateName + ".json");
+        }
+    }  catch (ConfigError) {
+        return false;
+    }
+    return true;
+}
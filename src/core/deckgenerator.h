@@ -0,0 +1,45 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef DECKGENERATOR_H
+#define DECKGENERATOR_H
+
+#include <QString>
+#include "configboxes.h"
+
+// Options of a synthetic presentation, e.g. to measure how the build pipeline scales
+struct DeckOptions {
+    int slides = 100;
+    int boxesPerSlide = 5;
+    // the presentation uses a generated template
+    bool useTemplate = false;
+    // probability that a text box is followed by a \pause
+    double pauseDensity = 0;
+    // a new \section starts every slidesPerSection slides, 0 for no sections
+    int slidesPerSection = 0;
+    // number of variables set with \setvar and used in the texts
+    int variables = 0;
+    // the same seed gives the same presentation
+    quint32 seed = 1;
+};
+
+struct GeneratedDeck {
+    QString text;
+    ConfigBoxes configuration;
+    // empty if the presentation does not use a template
+    QString templateText;
+    ConfigBoxes templateConfiguration;
+};
+
+// the name of the template used by generated presentations, relative to the presentation
+inline constexpr char generatedTemplateName[] = "template";
+
+GeneratedDeck generateDeck(DeckOptions const& options);
+// writes <baseName>.potato, <baseName>.json and the template files next to them,
+// returns false if a file cannot be written
+bool writeDeck(GeneratedDeck const& deck, QString const& baseName);
+
+#endif // DECKGENERATOR_H
@@ -0,0 +1,80 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "displaylistcache.h"
+#include "imagefileembedder.h"
+#include "latexcachemanager.h"
+
+namespace {
+// recordings of the previews, their images are downsampled to the size on screen
+constexpr std::size_t maximalRecordings = 256;
+}
+
+std::shared_ptr<RecordedSlide const> DisplayListCache::recording(SlideRenderer const& renderer, Slide::Ptr const& slide) {
+    auto const settings = QByteArray::number(int(renderer.renderHints())) + ' ' + QByteArray::number(renderer.maximalImageResolution())
+            + (renderer.imageFileEmbedder() ? ' ' + renderer.imageFileEmbedder()->cacheKey() : QByteArray());
+    auto const key = slide->fingerprint() + settings;
+    if(renderer.renderHints() & NoPreviewRendering) {
+        if(mExportRecording.key == key) {
+            mHits++;
+            return mExportRecording.recording;
+        }
+        mMisses++;
+        // the images of the previous slide are released before the next one is recorded
+        mExportRecording = {};
+        mExportRecording = {key, {}, std::make_shared<RecordedSlide const>(renderer.recordSlide(slide))};
+        return mExportRecording.recording;
+    }
+
+    auto const entry = mIndex.find(key);
+    if(entry != mIndex.end()) {
+        mHits++;
+        mEntries.splice(mEntries.end(), mEntries, entry->second);
+        return entry->second->recording;
+    }
+    mMisses++;
+    auto const source = Source{slide.get(), settings};
+    // the slide changed since it was recorded, e.g. while a box is dragged, the old recording is not shown anymore
+    if(auto const previous = mLatest.find(source); previous != mLatest.end()) {
+        erase(previous->second);
+    }
+    auto recording = std::make_shared<RecordedSlide const>(renderer.recordSlide(slide));
+    auto const inserted = mEntries.insert(mEntries.end(), {key, source, recording});
+    mIndex[key] = inserted;
+    mLatest[source] = inserted;
+    if(mEntries.size() > maximalRecordings) {
+        erase(mEntries.begin());
+    }
+    return recording;
+}
+
+void DisplayListCache::clear() {
+    mEntries.clear();
+    mIndex.clear();
+    mLatest.clear();
+    mExportRecording = {};
+}
+
+void DisplayListCache::erase(std::list<Entry>::iterator entry) {
+    mIndex.erase(entry->key);
+    if(auto const latest = mLatest.find(entry->source); latest != mLatest.end() && latest->second == entry) {
+        mLatest.erase(latest);
+    }
+    mEntries.erase(entry);
+}
+
+CacheStatistics DisplayListCache::statistics() const {
+    return {mHits, mMisses};
+}
+
+DisplayListCache& displayListCache() {
+    static DisplayListCache cache = []{
+        // formulas which were still converting are missing in the recordings
+        QObject::connect(&cacheManager(), &LatexCacheManager::conversionFinished, []{displayListCache().clear();});
+        return DisplayListCache();
+    }();
+    return cache;
+}
@@ -0,0 +1,55 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef DISPLAYLISTCACHE_H
+#define DISPLAYLISTCACHE_H
+
+#include "cachemanager.h"
+#include "sliderenderer.h"
+
+#include <list>
+#include <map>
+
+// Recorded slides by the fingerprint of the slide and the settings of the renderer they were drawn with.
+// The slide widget, the slide list and the template previews replay the same recordings,
+// so the boxes of a slide are laid out once until the slide changes. Exports replay the recording
+// of a slide on the pages of its pauses.
+// Like the caches of the images and formulas the boxes are drawn from, it is not thread-safe.
+class DisplayListCache
+{
+public:
+    // records the slide with the settings of renderer if there is no recording yet
+    std::shared_ptr<RecordedSlide const> recording(SlideRenderer const& renderer, Slide::Ptr const& slide);
+    // drops all recordings, e.g. when an image changed or a formula finished converting
+    void clear();
+    CacheStatistics statistics() const;
+
+private:
+    // the slide and the settings of the renderer a recording was made for
+    using Source = std::pair<Slide const*, QByteArray>;
+    struct Entry {
+        QByteArray key;
+        Source source;
+        std::shared_ptr<RecordedSlide const> recording;
+    };
+    void erase(std::list<Entry>::iterator entry);
+
+private:
+    // least recently used recording first
+    std::list<Entry> mEntries;
+    std::map<QByteArray, std::list<Entry>::iterator> mIndex;
+    // the last recording of a slide, it is dropped when the slide changed and is recorded again
+    std::map<Source, std::list<Entry>::iterator> mLatest;
+    // recordings of exports hold images in full resolution, only the one of the slide exported last
+    // is kept to replay it for the pauses
+    Entry mExportRecording;
+    qint64 mHits = 0;
+    qint64 mMisses = 0;
+};
+
+DisplayListCache& displayListCache();
+
+#endif // DISPLAYLISTCACHE_H
@@ -0,0 +1,97 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "imageexporter.h"
+#include "parallelexport.h"
+#include "tracing.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageWriter>
+#include <QMutex>
+#include <QPainter>
+#include <cmath>
+
+namespace {
+// size of the pdf page in inch
+constexpr double pageWidth = 297 / 25.4;
+constexpr double pageHeight = 167.0625 / 25.4;
+
+// rasterizes the page and writes it, returns the size of the file or -1 if it could not be written
+qint64 writePage(QPicture const& page, QString const& fileName, QSize dimensions, ImageExportOptions const& options) {
+    TraceSpan span("rasterize page", "export");
+    QImage image(qRound(pageWidth * options.dpi), qRound(pageHeight * options.dpi), QImage::Format_RGB32);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform | QPainter::TextAntialiasing);
+    painter.setWindow(QRect(QPoint(0, 0), dimensions));
+    painter.drawPicture(0, 0, page);
+    painter.end();
+
+    QImageWriter writer(fileName, options.format);
+    writer.setQuality(options.quality);
+    if(!writer.write(image)) {
+        return -1;
+    }
+    return QFileInfo(fileName).size();
+}
+}
+
+double ImageExportResult::imagesPerSecond() const {
+    return nanoseconds > 0 ? images / (nanoseconds / 1e9) : 0;
+}
+
+double ImageExportResult::megabytesPerSecond() const {
+    return nanoseconds > 0 ? bytes / 1e6 / (nanoseconds / 1e9) : 0;
+}
+
+ImageExportResult ImageExporter::exportImages(Presentation const& presentation, ImageExportOptions const& options) const {
+    TraceSpan span("exportImages", "export");
+    QElapsedTimer timer;
+    timer.start();
+    ImageExportResult result;
+    QDir().mkpath(options.directory);
+
+    auto const& slides = presentation.data().slideListDefaultApplied().vector;
+    auto const lastSlide = options.lastSlide < 0 ? int(slides.size()) - 1 : std::min(options.lastSlide, int(slides.size()) - 1);
+    auto const firstSlide = std::max(options.firstSlide, 0);
+    // every page is a chunk of its own and rasterized in parallel to the others
+    std::vector<std::vector<ExportPage>> pages;
+    for(int slideNumber = firstSlide; slideNumber <= lastSlide; slideNumber++) {
+        auto const& slide = slides[slideNumber];
+        auto const firstPause = options.pauses ? 0 : slide->numberPauses();
+        for(int pause = firstPause; pause <= slide->numberPauses(); pause++) {
+            pages.push_back({ExportPage{slide, pause}});
+        }
+    }
+    auto const digits = QString::number(pages.size()).size();
+    QStringList fileNames;
+    for(std::size_t page = 1; page <= pages.size(); page++) {
+        fileNames.append(QDir(options.directory).filePath(QString("%1-%2.%3").arg(options.baseName)
+                                                          .arg(page, digits, 10, QChar('0')).arg(QString(options.format))));
+    }
+
+    // images and svgs in full resolution, formulas are converted before the page is recorded
+    ParallelExportOptions exportOptions;
+    exportOptions.threads = options.threads;
+    QMutex resultMutex;
+    auto const dimensions = presentation.dimensions();
+    recordPagesInParallel(pages, exportOptions, [&](std::size_t page, std::vector<QPicture> const& pictures) {
+        auto const bytes = writePage(pictures.front(), fileNames[page], dimensions, options);
+        QMutexLocker locker(&resultMutex);
+        if(bytes >= 0) {
+            result.images++;
+            result.bytes += bytes;
+        }
+        else {
+            result.failedFiles.append(fileNames[page]);
+        }
+    });
+    result.nanoseconds = timer.nsecsElapsed();
+    return result;
+}
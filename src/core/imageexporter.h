@@ -0,0 +1,56 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef IMAGEEXPORTER_H
+#define IMAGEEXPORTER_H
+
+#include <QString>
+#include <QStringList>
+
+#include "presentation.h"
+
+struct ImageExportOptions {
+    // the images are written to <directory>/<baseName>-<page>.<format>
+    QString directory;
+    QString baseName = "slide";
+    // any format QImageWriter supports, e.g. png or jpg
+    QByteArray format = "png";
+    // quality of lossy formats from 0 to 100, -1 for the default of the format
+    int quality = -1;
+    // the page has the size of the exported pdf, 297mm x 167mm
+    int dpi = 150;
+    // first and last slide, counted from 0, -1 for the last slide
+    int firstSlide = 0;
+    int lastSlide = -1;
+    // write every pause of a slide as own image, otherwise only the complete slide
+    bool pauses = true;
+    // number of threads, 0 for one per core
+    int threads = 0;
+};
+
+struct ImageExportResult {
+    int images = 0;
+    qint64 bytes = 0;
+    qint64 nanoseconds = 0;
+    QStringList failedFiles;
+
+    bool success() const {
+        return failedFiles.empty();
+    }
+    double imagesPerSecond() const;
+    double megabytesPerSecond() const;
+};
+
+// Exports slides as image sequence, e.g. for video pipelines.
+// The pages are recorded one after the other in the calling thread, which resolves
+// LaTeX formulas and images, rasterized, encoded and written in a thread pool.
+class ImageExporter
+{
+public:
+    ImageExportResult exportImages(Presentation const& presentation, ImageExportOptions const& options) const;
+};
+
+#endif // IMAGEEXPORTER_H
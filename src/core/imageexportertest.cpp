@@ -0,0 +1,142 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "imageexportertest.h"
+#include "imageexporter.h"
+#include "latexcachemanager.h"
+#include "parser.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QTemporaryDir>
+
+QTEST_MAIN(ImageExporterTest)
+
+namespace {
+// three pages, the first slide has a pause
+auto const deck = std::string("\\slide first\n\\text First\n\\pause and more\n\\slide second\n\\text Second\n");
+
+Presentation::Ptr buildPresentation(QString const& directory) {
+    auto const parserOutput = generateSlides(deck, directory);
+    if(!parserOutput.successfull()) {
+        return {};
+    }
+    auto presentation = std::make_shared<Presentation>();
+    presentation->setData({parserOutput.slideList()});
+    return presentation;
+}
+
+ImageExportOptions createOptions(QString const& directory) {
+    ImageExportOptions options;
+    options.directory = directory;
+    options.dpi = 30;
+    return options;
+}
+}
+
+void ImageExporterTest::initTestCase() {
+    cacheManager().setStubConversion(true);
+}
+
+void ImageExporterTest::testExportPages() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    auto const presentation = buildPresentation(directory.path());
+    QVERIFY(presentation);
+    auto const result = ImageExporter().exportImages(*presentation, createOptions(directory.filePath("images")));
+    QVERIFY(result.success());
+    QCOMPARE(result.images, 3);
+    qint64 bytes = 0;
+    for(auto const& name : {"slide-1.png", "slide-2.png", "slide-3.png"}) {
+        auto const fileName = QDir(directory.filePath("images")).filePath(name);
+        QImage image(fileName);
+        QVERIFY2(!image.isNull(), name);
+        // the page has the size of the exported pdf
+        QCOMPARE(image.size(), QSize(qRound(297 / 25.4 * 30), qRound(167.0625 / 25.4 * 30)));
+        bytes += QFileInfo(fileName).size();
+    }
+    QCOMPARE(result.bytes, bytes);
+    QVERIFY(!QFileInfo::exists(QDir(directory.filePath("images")).filePath("slide-4.png")));
+}
+
+void ImageExporterTest::testSelectPages() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    auto const presentation = buildPresentation(directory.path());
+    QVERIFY(presentation);
+    auto options = createOptions(directory.filePath("complete"));
+    options.pauses = false;
+    QCOMPARE(ImageExporter().exportImages(*presentation, options).images, 2);
+
+    options = createOptions(directory.filePath("second"));
+    options.firstSlide = 1;
+    options.baseName = "page";
+    QCOMPARE(ImageExporter().exportImages(*presentation, options).images, 1);
+    QVERIFY(QFileInfo::exists(QDir(options.directory).filePath("page-1.png")));
+}
+
+void ImageExporterTest::testSameImagesWithThreads() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    auto const presentation = buildPresentation(directory.path());
+    QVERIFY(presentation);
+    auto options = createOptions(directory.filePath("single"));
+    options.threads = 1;
+    QCOMPARE(ImageExporter().exportImages(*presentation, options).images, 3);
+    options.directory = directory.filePath("parallel");
+    options.threads = 4;
+    QCOMPARE(ImageExporter().exportImages(*presentation, options).images, 3);
+    for(auto const& name : {"slide-1.png", "slide-2.png", "slide-3.png"}) {
+        QCOMPARE(QImage(QDir(directory.filePath("parallel")).filePath(name)),
+                 QImage(QDir(directory.filePath("single")).filePath(name)));
+    }
+    // the pause adds a box to the first slide
+    QVERIFY(QImage(QDir(directory.filePath("single")).filePath("slide-1.png"))
+            != QImage(QDir(directory.filePath("single")).filePath("slide-2.png")));
+}
+
+void ImageExporterTest::testFailedFiles() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    auto const presentation = buildPresentation(directory.path());
+    QVERIFY(presentation);
+    auto options = createOptions(directory.filePath("images"));
+    options.format = "no-such-format";
+    auto const result = ImageExporter().exportImages(*presentation, options);
+    QVERIFY(!result.success());
+    QCOMPARE(result.images, 0);
+    QCOMPARE(result.failedFiles.size(), 3);
+}
+
+void ImageExporterTest::testChangedImageFile() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    auto const imagePath = directory.filePath("picture.png");
+    QImage image(40, 30, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    QVERIFY(image.save(imagePath));
+    auto const parserOutput = generateSlides("\\slide picture\n\\image picture.png\n", directory.path());
+    QVERIFY(parserOutput.successfull());
+    auto presentation = std::make_shared<Presentation>();
+    presentation->setData({parserOutput.slideList()});
+    auto const slide = presentation->data().slideListDefaultApplied().vector.front();
+    auto const fingerprint = slide->fingerprint();
+    QCOMPARE(ImageExporter().exportImages(*presentation, createOptions(directory.filePath("red"))).images, 1);
+
+    // only the file on disk changes, the slide stays the same
+    image.fill(Qt::blue);
+    QVERIFY(image.save(imagePath));
+    QFile file(imagePath);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(10), QFileDevice::FileModificationTime));
+    file.close();
+    QVERIFY(slide->fingerprint() != fingerprint);
+    QCOMPARE(ImageExporter().exportImages(*presentation, createOptions(directory.filePath("blue"))).images, 1);
+    QVERIFY(QImage(QDir(directory.filePath("red")).filePath("slide-1.png"))
+            != QImage(QDir(directory.filePath("blue")).filePath("slide-1.png")));
+}
@@ -0,0 +1,24 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef IMAGEEXPORTERTEST_H
+#define IMAGEEXPORTERTEST_H
+
+#include <QtTest/QTest>
+
+class ImageExporterTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testExportPages();
+    void testSelectPages();
+    void testSameImagesWithThreads();
+    void testFailedFiles();
+    void testChangedImageFile();
+};
+
+#endif // IMAGEEXPORTERTEST_H
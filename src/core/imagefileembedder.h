@@ -0,0 +1,28 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef IMAGEFILEEMBEDDER_H
+#define IMAGEFILEEMBEDDER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <optional>
+
+// Image files an export embeds unchanged instead of decoding and encoding them again.
+// Image boxes draw the placeholder of the file instead of the image and the exporter
+// replaces the placeholder by the file when it writes the document.
+class ImageFileEmbedder
+{
+public:
+    virtual ~ImageFileEmbedder() = default;
+    // nullopt if the file cannot be embedded unchanged
+    virtual std::optional<QImage> placeholder(QString const& path) = 0;
+    // recordings with placeholders are only replayed for an embedder with the same key
+    virtual QByteArray cacheKey() const = 0;
+};
+
+#endif // IMAGEFILEEMBEDDER_H
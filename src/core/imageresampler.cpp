@@ -0,0 +1,390 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "imageresampler.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define RESAMPLE_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define RESAMPLE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// source pixels covered by each destination pixel, the weights of one destination pixel sum up to 1
+struct Contributions {
+    std::vector<int> first;
+    std::vector<int> count;
+    std::vector<int> offset;
+    std::vector<float> weights;
+};
+
+Contributions areaContributions(int sourceSize, int destinationSize) {
+    Contributions contributions;
+    auto const scale = double(sourceSize) / destinationSize;
+    for(int index = 0; index < destinationSize; index++) {
+        auto const start = index * scale;
+        auto const end = (index + 1) * scale;
+        auto const first = int(start);
+        auto const last = std::min(int(std::ceil(end)), sourceSize);
+        contributions.first.push_back(first);
+        contributions.count.push_back(last - first);
+        contributions.offset.push_back(int(contributions.weights.size()));
+        for(int source = first; source < last; source++) {
+            auto const coverage = std::min(end, source + 1.0) - std::max(start, double(source));
+            contributions.weights.push_back(float(coverage / scale));
+        }
+    }
+    return contributions;
+}
+
+// averages the source pixels 2x and 2x + 1 of both rows into the destination pixels x >= first
+using HalveRow = void (*)(uchar const* row0, uchar const* row1, uchar* destination, int destinationWidth, int sourceWidth, int first);
+// filters a row of source pixels horizontally into four float channels per destination pixel
+using FilterRow = void (*)(uchar const* source, float* destination, Contributions const& contributions);
+// adds weight times the row to sum, both have size floats
+using AccumulateRow = void (*)(float* sum, float const* row, float weight, int size);
+
+struct Kernels {
+    HalveRow halveRow;
+    FilterRow filterRow;
+    AccumulateRow accumulateRow;
+};
+
+void halveRowScalar(uchar const* row0, uchar const* row1, uchar* destination, int destinationWidth, int sourceWidth, int first) {
+    for(int x = first; x < destinationWidth; x++) {
+        auto const left = 4 * 2 * x;
+        auto const right = 4 * std::min(2 * x + 1, sourceWidth - 1);
+        for(int channel = 0; channel < 4; channel++) {
+            destination[4 * x + channel] = uchar((row0[left + channel] + row0[right + channel]
+                                                  + row1[left + channel] + row1[right + channel] + 2) >> 2);
+        }
+    }
+}
+
+void filterRowScalar(uchar const* source, float* destination, Contributions const& contributions) {
+    for(std::size_t x = 0; x < contributions.first.size(); x++) {
+        float sum[4] = {0, 0, 0, 0};
+        auto const* pixel = source + 4 * contributions.first[x];
+        auto const* weight = contributions.weights.data() + contributions.offset[x];
+        for(int index = 0; index < contributions.count[x]; index++, pixel += 4) {
+            for(int channel = 0; channel < 4; channel++) {
+                sum[channel] += weight[index] * pixel[channel];
+            }
+        }
+        std::copy(sum, sum + 4, destination + 4 * x);
+    }
+}
+
+void accumulateRowScalar(float* sum, float const* row, float weight, int size) {
+    for(int index = 0; index < size; index++) {
+        sum[index] += weight * row[index];
+    }
+}
+
+#ifdef RESAMPLE_X86
+void halveRowSse2(uchar const* row0, uchar const* row1, uchar* destination, int destinationWidth, int sourceWidth, int first) {
+    auto const zero = _mm_setzero_si128();
+    auto const rounding = _mm_set1_epi16(2);
+    auto const pairs = std::min(destinationWidth, sourceWidth / 2);
+    auto x = first;
+    // four destination pixels from eight source pixels of each row
+    for(; x + 4 <= pairs; x += 4) {
+        auto const top0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row0 + 8 * x));
+        auto const top1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row0 + 8 * x + 16));
+        auto const bottom0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row1 + 8 * x));
+        auto const bottom1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row1 + 8 * x + 16));
+        // 16 bit channels of two neighbouring pixels, summed over both rows
+        auto const sum01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+        auto const sum23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+        auto const sum45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+        auto const sum67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+        // the right pixel of each pair is added to the left one in the lower half
+        auto const low = _mm_unpacklo_epi64(_mm_add_epi16(sum01, _mm_srli_si128(sum01, 8)),
+                                            _mm_add_epi16(sum23, _mm_srli_si128(sum23, 8)));
+        auto const high = _mm_unpacklo_epi64(_mm_add_epi16(sum45, _mm_srli_si128(sum45, 8)),
+                                             _mm_add_epi16(sum67, _mm_srli_si128(sum67, 8)));
+        auto const averageLow = _mm_srli_epi16(_mm_add_epi16(low, rounding), 2);
+        auto const averageHigh = _mm_srli_epi16(_mm_add_epi16(high, rounding), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 4 * x), _mm_packus_epi16(averageLow, averageHigh));
+    }
+    halveRowScalar(row0, row1, destination, destinationWidth, sourceWidth, x);
+}
+
+void filterRowSse2(uchar const* source, float* destination, Contributions const& contributions) {
+    auto const zero = _mm_setzero_si128();
+    for(std::size_t x = 0; x < contributions.first.size(); x++) {
+        auto sum = _mm_setzero_ps();
+        auto const* pixel = source + 4 * contributions.first[x];
+        auto const* weight = contributions.weights.data() + contributions.offset[x];
+        for(int index = 0; index < contributions.count[x]; index++, pixel += 4) {
+            int value;
+            std::memcpy(&value, pixel, 4);
+            auto const channels = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero));
+            sum = _mm_add_ps(sum, _mm_mul_ps(channels, _mm_set1_ps(weight[index])));
+        }
+        _mm_storeu_ps(destination + 4 * x, sum);
+    }
+}
+
+void accumulateRowSse2(float* sum, float const* row, float weight, int size) {
+    auto const factor = _mm_set1_ps(weight);
+    int index = 0;
+    for(; index + 4 <= size; index += 4) {
+        _mm_storeu_ps(sum + index, _mm_add_ps(_mm_loadu_ps(sum + index), _mm_mul_ps(_mm_loadu_ps(row + index), factor)));
+    }
+    accumulateRowScalar(sum + index, row + index, weight, size - index);
+}
+
+__attribute__((target("avx2")))
+void halveRowAvx2(uchar const* row0, uchar const* row1, uchar* destination, int destinationWidth, int sourceWidth, int first) {
+    auto const rounding = _mm256_set1_epi16(2);
+    auto const pairs = std::min(destinationWidth, sourceWidth / 2);
+    auto x = first;
+    // eight destination pixels from sixteen source pixels of each row
+    for(; x + 8 <= pairs; x += 8) {
+        __m256i pairSums[4];
+        for(int part = 0; part < 4; part++) {
+            // four pixels with 16 bit channels, one pixel per 64 bit lane
+            auto const top = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(row0 + 8 * x + 16 * part)));
+            auto const bottom = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(row1 + 8 * x + 16 * part)));
+            // left pixels of the pairs in the lower, right pixels in the upper half
+            auto const sum = _mm256_permute4x64_epi64(_mm256_add_epi16(top, bottom), _MM_SHUFFLE(3, 1, 2, 0));
+            pairSums[part] = _mm256_add_epi16(sum, _mm256_permute2x128_si256(sum, sum, 0x01));
+        }
+        auto const average0 = _mm256_srli_epi16(_mm256_add_epi16(_mm256_permute2x128_si256(pairSums[0], pairSums[1], 0x20), rounding), 2);
+        auto const average1 = _mm256_srli_epi16(_mm256_add_epi16(_mm256_permute2x128_si256(pairSums[2], pairSums[3], 0x20), rounding), 2);
+        // packing works within the 128 bit lanes, the 64 bit lanes are sorted afterwards
+        auto const packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(average0, average1), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + 4 * x), packed);
+    }
+    halveRowScalar(row0, row1, destination, destinationWidth, sourceWidth, x);
+}
+
+__attribute__((target("avx2")))
+void accumulateRowAvx2(float* sum, float const* row, float weight, int size) {
+    auto const factor = _mm256_set1_ps(weight);
+    int index = 0;
+    for(; index + 8 <= size; index += 8) {
+        _mm256_storeu_ps(sum + index, _mm256_add_ps(_mm256_loadu_ps(sum + index), _mm256_mul_ps(_mm256_loadu_ps(row + index), factor)));
+    }
+    accumulateRowScalar(sum + index, row + index, weight, size - index);
+}
+#endif
+
+#ifdef RESAMPLE_NEON
+void halveRowNeon(uchar const* row0, uchar const* row1, uchar* destination, int destinationWidth, int sourceWidth, int first) {
+    auto const pairs = std::min(destinationWidth, sourceWidth / 2);
+    auto x = first;
+    // eight destination pixels from sixteen source pixels of each row, split into the channels
+    for(; x + 8 <= pairs; x += 8) {
+        auto const top = vld4q_u8(row0 + 8 * x);
+        auto const bottom = vld4q_u8(row1 + 8 * x);
+        uint8x8x4_t average;
+        for(int channel = 0; channel < 4; channel++) {
+            auto const sum = vaddq_u16(vpaddlq_u8(top.val[channel]), vpaddlq_u8(bottom.val[channel]));
+            average.val[channel] = vrshrn_n_u16(sum, 2);
+        }
+        vst4_u8(destination + 4 * x, average);
+    }
+    halveRowScalar(row0, row1, destination, destinationWidth, sourceWidth, x);
+}
+
+void filterRowNeon(uchar const* source, float* destination, Contributions const& contributions) {
+    for(std::size_t x = 0; x < contributions.first.size(); x++) {
+        auto sum = vdupq_n_f32(0);
+        auto const* pixel = source + 4 * contributions.first[x];
+        auto const* weight = contributions.weights.data() + contributions.offset[x];
+        for(int index = 0; index < contributions.count[x]; index++, pixel += 4) {
+            quint32 value;
+            std::memcpy(&value, pixel, 4);
+            auto const channels = vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vcreate_u8(value)))));
+            sum = vaddq_f32(sum, vmulq_n_f32(channels, weight[index]));
+        }
+        vst1q_f32(destination + 4 * x, sum);
+    }
+}
+
+void accumulateRowNeon(float* sum, float const* row, float weight, int size) {
+    int index = 0;
+    for(; index + 4 <= size; index += 4) {
+        vst1q_f32(sum + index, vaddq_f32(vld1q_f32(sum + index), vmulq_n_f32(vld1q_f32(row + index), weight)));
+    }
+    accumulateRowScalar(sum + index, row + index, weight, size - index);
+}
+#endif
+
+Kernels kernelsOf(ResampleKernel kernel) {
+    if(!resampleKernelSupported(kernel)) {
+        kernel = ResampleKernel::Scalar;
+    }
+    switch(kernel) {
+#ifdef RESAMPLE_X86
+    case ResampleKernel::Sse2:
+        return {halveRowSse2, filterRowSse2, accumulateRowSse2};
+    case ResampleKernel::Avx2:
+        // one pixel of the horizontal filter fits into 128 bits
+        return {halveRowAvx2, filterRowSse2, accumulateRowAvx2};
+#endif
+#ifdef RESAMPLE_NEON
+    case ResampleKernel::Neon:
+        return {halveRowNeon, filterRowNeon, accumulateRowNeon};
+#endif
+    default:
+        return {halveRowScalar, filterRowScalar, accumulateRowScalar};
+    }
+}
+
+// premultiplied color channels cannot exceed alpha, rounding errors of the filter are clamped
+void storeRow(float const* row, uchar* destination, int width) {
+    for(int x = 0; x < width; x++) {
+        auto const alpha = std::clamp(int(row[4 * x + 3] + 0.5f), 0, 255);
+        for(int channel = 0; channel < 3; channel++) {
+            destination[4 * x + channel] = uchar(std::clamp(int(row[4 * x + channel] + 0.5f), 0, alpha));
+        }
+        destination[4 * x + 3] = uchar(alpha);
+    }
+}
+
+// average of the source pixels of the destination pixel, the last pixels also cover an odd last column or row
+void averageBlock(QImage const& source, QImage& destination, int x, int y) {
+    auto const lastX = x + 1 == destination.width() ? source.width() : 2 * x + 2;
+    auto const lastY = y + 1 == destination.height() ? source.height() : 2 * y + 2;
+    auto const count = (lastX - 2 * x) * (lastY - 2 * y);
+    int sum[4] = {0, 0, 0, 0};
+    for(int row = 2 * y; row < lastY; row++) {
+        auto const* pixel = source.constScanLine(row) + 4 * 2 * x;
+        for(int column = 2 * x; column < lastX; column++, pixel += 4) {
+            for(int channel = 0; channel < 4; channel++) {
+                sum[channel] += pixel[channel];
+            }
+        }
+    }
+    auto* target = destination.scanLine(y) + 4 * x;
+    for(int channel = 0; channel < 4; channel++) {
+        target[channel] = uchar((sum[channel] + count / 2) / count);
+    }
+}
+}
+
+ResampleKernel bestResampleKernel() {
+    static auto const kernel = []{
+        for(auto const kernel : {ResampleKernel::Avx2, ResampleKernel::Neon, ResampleKernel::Sse2}) {
+            if(resampleKernelSupported(kernel)) {
+                return kernel;
+            }
+        }
+        return ResampleKernel::Scalar;
+    }();
+    return kernel;
+}
+
+bool resampleKernelSupported(ResampleKernel kernel) {
+    switch(kernel) {
+    case ResampleKernel::Scalar:
+        return true;
+#ifdef RESAMPLE_X86
+    case ResampleKernel::Sse2:
+        return true;
+    case ResampleKernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#ifdef RESAMPLE_NEON
+    case ResampleKernel::Neon:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+QString resampleKernelName(ResampleKernel kernel) {
+    switch(kernel) {
+    case ResampleKernel::Scalar:
+        return "scalar";
+    case ResampleKernel::Sse2:
+        return "sse2";
+    case ResampleKernel::Avx2:
+        return "avx2";
+    case ResampleKernel::Neon:
+        return "neon";
+    }
+    return {};
+}
+
+QImage halveImage(QImage const& image, ResampleKernel kernel) {
+    if(image.isNull()) {
+        return {};
+    }
+    auto const source = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    auto const width = std::max(1, source.width() / 2);
+    auto const height = std::max(1, source.height() / 2);
+    QImage destination(width, height, QImage::Format_ARGB32_Premultiplied);
+    auto const halveRow = kernelsOf(kernel).halveRow;
+    for(int y = 0; y < height; y++) {
+        halveRow(source.constScanLine(2 * y), source.constScanLine(std::min(2 * y + 1, source.height() - 1)),
+                 destination.scanLine(y), width, source.width(), 0);
+    }
+    // the odd last column and row are averaged into the last pixels instead of being dropped
+    if(source.width() % 2 == 1) {
+        for(int y = 0; y < height; y++) {
+            averageBlock(source, destination, width - 1, y);
+        }
+    }
+    if(source.height() % 2 == 1) {
+        for(int x = 0; x < width; x++) {
+            averageBlock(source, destination, x, height - 1);
+        }
+    }
+    return destination;
+}
+
+QImage downscaleImage(QImage const& image, QSize size, ResampleKernel kernel) {
+    TraceSpan span("downscaleImage", "image");
+    if(image.isNull() || size.isEmpty()) {
+        return {};
+    }
+    if(size.width() > image.width() || size.height() > image.height()) {
+        return image.convertToFormat(QImage::Format_ARGB32_Premultiplied).scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    auto source = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    while(source.width() >= 2 * size.width() && source.height() >= 2 * size.height()) {
+        source = halveImage(source, kernel);
+    }
+    if(source.size() == size) {
+        return source;
+    }
+
+    // separable area filter: every source row horizontally, then the filtered rows vertically
+    auto const kernels = kernelsOf(kernel);
+    auto const horizontal = areaContributions(source.width(), size.width());
+    auto const vertical = areaContributions(source.height(), size.height());
+    auto const rowSize = 4 * size.width();
+    std::vector<float> filteredRows(std::size_t(rowSize) * source.height());
+    for(int y = 0; y < source.height(); y++) {
+        kernels.filterRow(source.constScanLine(y), filteredRows.data() + std::size_t(rowSize) * y, horizontal);
+    }
+    QImage destination(size, QImage::Format_ARGB32_Premultiplied);
+    std::vector<float> sum(rowSize);
+    for(int y = 0; y < size.height(); y++) {
+        std::fill(sum.begin(), sum.end(), 0.f);
+        for(int index = 0; index < vertical.count[y]; index++) {
+            auto const row = vertical.first[y] + index;
+            kernels.accumulateRow(sum.data(), filteredRows.data() + std::size_t(rowSize) * row,
+                                  vertical.weights[vertical.offset[y] + index], rowSize);
+        }
+        storeRow(sum.data(), destination.scanLine(y), size.width());
+    }
+    return destination;
+}
@@ -0,0 +1,34 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef IMAGERESAMPLER_H
+#define IMAGERESAMPLER_H
+
+#include <QImage>
+
+// Instruction sets of the downscaling kernels, the best one the CPU supports is chosen at runtime.
+enum class ResampleKernel {
+    Scalar,
+    Sse2,
+    Avx2,
+    Neon
+};
+
+ResampleKernel bestResampleKernel();
+bool resampleKernelSupported(ResampleKernel kernel);
+QString resampleKernelName(ResampleKernel kernel);
+
+// Halves width and height with a 2x2 box filter, e.g. for mip levels. Odd sizes are rounded down, but not below 1,
+// and the last column or row of an odd size is averaged into the last pixels.
+// The result is premultiplied ARGB32.
+QImage halveImage(QImage const& image, ResampleKernel kernel = bestResampleKernel());
+
+// Scales the image down to size with an area filter. The image is halved as long as it is larger
+// than twice the size, so the area filter only covers the last step.
+// Returns a smoothly scaled copy if size is larger than the image. The result is premultiplied ARGB32.
+QImage downscaleImage(QImage const& image, QSize size, ResampleKernel kernel = bestResampleKernel());
+
+#endif // IMAGERESAMPLER_H
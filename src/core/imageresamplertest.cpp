@@ -0,0 +1,108 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "imageresamplertest.h"
+#include "imageresampler.h"
+
+#include <QImage>
+#include <cstdlib>
+
+QTEST_GUILESS_MAIN(ImageResamplerTest)
+Q_DECLARE_METATYPE(ResampleKernel)
+
+namespace {
+// premultiplied pixels with varying alpha, odd sizes cover the scalar tails of the kernels
+QImage patternImage(QSize size) {
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    for(int y = 0; y < image.height(); y++) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for(int x = 0; x < image.width(); x++) {
+            line[x] = qPremultiply(qRgba((x * 7) % 256, (y * 13) % 256, (x + y) % 256, (x * y + 31) % 256));
+        }
+    }
+    return image;
+}
+
+void verifyPremultiplied(QImage const& image) {
+    QCOMPARE(image.format(), QImage::Format_ARGB32_Premultiplied);
+    for(int y = 0; y < image.height(); y++) {
+        auto const* line = reinterpret_cast<QRgb const*>(image.constScanLine(y));
+        for(int x = 0; x < image.width(); x++) {
+            auto const alpha = qAlpha(line[x]);
+            QVERIFY(qRed(line[x]) <= alpha && qGreen(line[x]) <= alpha && qBlue(line[x]) <= alpha);
+        }
+    }
+}
+}
+
+void ImageResamplerTest::testKernels() {
+    QFETCH(ResampleKernel, kernel);
+    if(!resampleKernelSupported(kernel)) {
+        QSKIP("The kernel is not supported by this CPU.");
+    }
+    for(auto const size : {QSize(64, 48), QSize(77, 35), QSize(3, 1)}) {
+        auto const image = patternImage(size);
+        // halving rounds exactly like the scalar kernel, the area filter may differ by one step
+        QCOMPARE(halveImage(image, kernel), halveImage(image, ResampleKernel::Scalar));
+        auto const target = QSize(std::max(1, size.width() / 3), std::max(1, size.height() / 3));
+        auto const expected = downscaleImage(image, target, ResampleKernel::Scalar);
+        auto const result = downscaleImage(image, target, kernel);
+        QCOMPARE(result.size(), target);
+        for(int y = 0; y < target.height(); y++) {
+            for(int x = 0; x < 4 * target.width(); x++) {
+                QVERIFY(std::abs(result.constScanLine(y)[x] - expected.constScanLine(y)[x]) <= 1);
+            }
+        }
+    }
+}
+
+void ImageResamplerTest::testKernels_data() {
+    QTest::addColumn<ResampleKernel>("kernel");
+    for(auto const kernel : {ResampleKernel::Sse2, ResampleKernel::Avx2, ResampleKernel::Neon}) {
+        QTest::newRow(resampleKernelName(kernel).toUtf8().constData()) << kernel;
+    }
+}
+
+void ImageResamplerTest::testConstantColor() {
+    auto const color = qPremultiply(qRgba(200, 100, 50, 128));
+    QImage image(37, 21, QImage::Format_ARGB32_Premultiplied);
+    image.fill(color);
+    for(auto const& result : {halveImage(image), downscaleImage(image, QSize(10, 7)), downscaleImage(image, QSize(4, 2))}) {
+        for(int y = 0; y < result.height(); y++) {
+            for(int x = 0; x < result.width(); x++) {
+                QCOMPARE(result.pixel(x, y), qUnpremultiply(color));
+            }
+        }
+    }
+}
+
+void ImageResamplerTest::testPremultiplied() {
+    auto const image = patternImage(QSize(101, 67));
+    verifyPremultiplied(halveImage(image));
+    verifyPremultiplied(downscaleImage(image, QSize(30, 20)));
+    verifyPremultiplied(downscaleImage(image, QSize(7, 5)));
+}
+
+void ImageResamplerTest::testOddEdges() {
+    // the third column is part of the only pixel instead of being dropped
+    QImage image(3, 1, QImage::Format_ARGB32_Premultiplied);
+    image.setPixel(0, 0, qRgba(0, 0, 0, 255));
+    image.setPixel(1, 0, qRgba(0, 0, 0, 255));
+    image.setPixel(2, 0, qRgba(255, 255, 255, 255));
+    auto const halved = halveImage(image, ResampleKernel::Scalar);
+    QCOMPARE(halved.size(), QSize(1, 1));
+    QCOMPARE(halved.pixel(0, 0), qRgba(85, 85, 85, 255));
+
+    // the last row is averaged into the last row of pixels, the others keep their 2x2 blocks
+    QImage column(2, 5, QImage::Format_ARGB32_Premultiplied);
+    column.fill(qRgba(0, 0, 0, 255));
+    column.setPixel(0, 4, qRgba(240, 240, 240, 255));
+    column.setPixel(1, 4, qRgba(240, 240, 240, 255));
+    auto const halvedColumn = halveImage(column, ResampleKernel::Scalar);
+    QCOMPARE(halvedColumn.size(), QSize(1, 2));
+    QCOMPARE(halvedColumn.pixel(0, 0), qRgba(0, 0, 0, 255));
+    QCOMPARE(halvedColumn.pixel(0, 1), qRgba(80, 80, 80, 255));
+}
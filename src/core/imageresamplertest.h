@@ -0,0 +1,23 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef IMAGERESAMPLERTEST_H
+#define IMAGERESAMPLERTEST_H
+
+#include <QtTest/QTest>
+
+class ImageResamplerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testKernels();
+    void testKernels_data();
+    void testConstantColor();
+    void testPremultiplied();
+    void testOddEdges();
+};
+
+#endif // IMAGERESAMPLERTEST_H
@@ -5,8 +5,18 @@
 */
 
 #include "latexcachemanager.h"
+#include "tracing.h"
 #include <QDir>
 #include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace {
+auto const beginDocument = QString("\\begin{document}");
+// crashed workers are replaced, but not if pdflatex keeps crashing
+constexpr int maximalWorkerRestarts = 3;
+}
 
 LatexCacheManager::LatexCacheManager()
 {
@@ -29,6 +39,13 @@ LatexCacheManager::~LatexCacheManager()
             job.mProcess->waitForFinished();
         }
     }
+    for(auto const& worker: mWarmWorkers) {
+        if(worker.mProcess->state() != QProcess::NotRunning) {
+            worker.mProcess->disconnect(this);
+            worker.mProcess->terminate();
+            worker.mProcess->waitForFinished();
+        }
+    }
 }
 
 LatexCacheManager& cacheManager()
@@ -38,12 +55,34 @@ LatexCacheManager& cacheManager()
 }
 
 void LatexCacheManager::startConversionProcess(QString latexInput, ConversionType conversionType) {
+    if(mStubConversion) {
+        static auto const emptySvg = QByteArray("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"10\" height=\"10\"/>");
+        mCachedImages[latexInput] = SvgEntry{SvgStatus::Success, std::make_shared<QSvgRenderer>(emptySvg)};
+        return;
+    }
     if(mRunningLatexJobs.size() + mRunningPdfToSvgJobs.size() > QThread::idealThreadCount()){
         mCachedImages[latexInput] = SvgEntry{SvgStatus::NotStarted, nullptr};
         return;
     }
     mCachedImages[latexInput] = SvgEntry{SvgStatus::Pending, nullptr};
 
+    auto const documentStart = latexInput.indexOf(beginDocument);
+    if(mNumberOfWarmWorkers > 0 && documentStart >= 0) {
+        auto const preamble = latexInput.left(documentStart + beginDocument.size());
+        auto worker = takeWarmWorker(preamble);
+        if(!worker) {
+            worker = startWarmWorker(preamble);
+        }
+        // the next formula with this preamble finds a worker which has loaded it already,
+        // preambles used once, e.g. with the size of a box which is being resized, are not loaded in advance
+        if(++mPreambleUses[preamble] > 1) {
+            prepareWarmWorker(preamble);
+        }
+        if(worker && startWarmJob(std::move(*worker), latexInput.mid(documentStart + beginDocument.size()), latexInput, conversionType)) {
+            return;
+        }
+    }
+
     auto tempDir = std::make_unique<QTemporaryDir>();
     if (!tempDir->isValid()) {
         return;
@@ -55,7 +94,6 @@ void LatexCacheManager::startConversionProcess(QString latexInput, ConversionTyp
     inputFile.write(latexInput.toUtf8());
     inputFile.close();
 
-    QString program = "/usr/bin/pdflatex";
     QStringList arguments;
     arguments << "-halt-on-error" << "-interaction=nonstopmode" << "-output-directory=" + tempDir->path() << inputFile.fileName();
 
@@ -64,14 +102,158 @@ void LatexCacheManager::startConversionProcess(QString latexInput, ConversionTyp
     job.mTempDir = std::move(tempDir);
     job.mInput = latexInput;
     job.mConversionType = conversionType;
+    job.mStartTime = tracer().enabled() ? tracer().now() : -1;
 
     connect(job.mProcess.get(), QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &LatexCacheManager::startSvgGeneration);
 
-    job.mProcess->start(program, arguments);
+    job.mProcess->start(mPdflatex, arguments);
+    watchProcess(job.mProcess.get(), conversionType);
+}
+
+bool LatexCacheManager::startWarmJob(WarmWorker worker, QString const& body, QString const& latexInput, ConversionType conversionType) {
+    auto bodyFile = QFile(worker.mTempDir->path() + "/formula.tex");
+    if(!bodyFile.open(QIODevice::WriteOnly)) {
+        stopWarmWorker(worker);
+        return false;
+    }
+    bodyFile.write(body.toUtf8());
+    bodyFile.close();
+
+    auto& job = mRunningLatexJobs.emplace_back();
+    job.mProcess = std::move(worker.mProcess);
+    job.mTempDir = std::move(worker.mTempDir);
+    job.mInput = latexInput;
+    job.mConversionType = conversionType;
+    job.mStartTime = tracer().enabled() ? tracer().now() : -1;
+
+    job.mProcess->disconnect(this);
+    connect(job.mProcess.get(), QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &LatexCacheManager::startSvgGeneration);
+    // any line continues the worker, it reads the body from formula.tex.
+    // If pdflatex asks for a missing file of the preamble instead, "x" quits and the end of stdin stops further questions.
+    job.mProcess->write("x\n");
+    job.mProcess->closeWriteChannel();
+    watchProcess(job.mProcess.get(), conversionType);
+    return true;
+}
 
+void LatexCacheManager::watchProcess(QProcess* process, ConversionType conversionType) const {
     if(conversionType == BreakUntillFinished) {
-        job.mProcess->waitForFinished(-1);
+        if(!process->waitForFinished(mConversionTimeout)) {
+            qWarning() << "LaTeX conversion timed out";
+            process->kill();
+            process->waitForFinished(-1);
+        }
+        return;
+    }
+    // the timer is dropped together with the process
+    QTimer::singleShot(mConversionTimeout, process, [process]{
+        if(process->state() != QProcess::NotRunning) {
+            qWarning() << "LaTeX conversion timed out";
+            process->kill();
+        }
+    });
+}
+
+std::optional<WarmWorker> LatexCacheManager::startWarmWorker(QString const& preamble) {
+    auto tempDir = std::make_unique<QTemporaryDir>();
+    if (!tempDir->isValid()) {
+        return std::nullopt;
+    }
+    auto inputFile = QFile(tempDir->path() + "/input.tex");
+    if(!inputFile.open(QIODevice::WriteOnly)) {
+        return std::nullopt;
+    }
+    // waits for a line on stdin before it reads the body, terminal input needs at least scrollmode
+    inputFile.write((preamble + "\\read-1 to\\potatoBodyReady\\input{formula.tex}").toUtf8());
+    inputFile.close();
+
+    QStringList arguments;
+    arguments << "-halt-on-error" << "-interaction=scrollmode" << "-output-directory=" + tempDir->path() << inputFile.fileName();
+
+    WarmWorker worker;
+    worker.mProcess.reset(new QProcess());
+    worker.mProcess->setWorkingDirectory(tempDir->path());
+    worker.mTempDir = std::move(tempDir);
+    worker.mPreamble = preamble;
+    connect(worker.mProcess.get(), QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &LatexCacheManager::restartFinishedWarmWorkers);
+    worker.mProcess->start(mPdflatex, arguments);
+    return worker;
+}
+
+std::optional<WarmWorker> LatexCacheManager::takeWarmWorker(QString const& preamble) {
+    auto const worker = std::find_if(mWarmWorkers.begin(), mWarmWorkers.end(), [&preamble](auto const& worker){
+        return worker.mPreamble == preamble && worker.mProcess->state() != QProcess::NotRunning;
+    });
+    if(worker == mWarmWorkers.end()) {
+        return std::nullopt;
+    }
+    auto ret = std::move(*worker);
+    mWarmWorkers.erase(worker);
+    return ret;
+}
+
+void LatexCacheManager::prepareWarmWorker(QString const& preamble) {
+    // the oldest workers wait for preambles which are least likely to come again
+    while(!mWarmWorkers.empty() && int(mWarmWorkers.size()) >= mNumberOfWarmWorkers) {
+        stopWarmWorker(mWarmWorkers.front());
+        mWarmWorkers.erase(mWarmWorkers.begin());
+    }
+    if(mNumberOfWarmWorkers <= 0) {
+        return;
+    }
+    if(auto worker = startWarmWorker(preamble)) {
+        mWarmWorkers.push_back(std::move(*worker));
+    }
+}
+
+void LatexCacheManager::stopWarmWorker(WarmWorker& worker) {
+    if(!worker.mProcess) {
+        return;
+    }
+    // pdflatex stops at the end of stdin, the process and its directory are deleted once it has finished
+    auto* process = worker.mProcess.release();
+    process->disconnect(this);
+    if(process->state() == QProcess::NotRunning) {
+        process->deleteLater();
+        worker.mTempDir.reset();
+        return;
+    }
+    auto* tempDir = worker.mTempDir.release();
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), process, [process, tempDir]{
+        delete tempDir;
+        process->deleteLater();
+    });
+    process->closeWriteChannel();
+}
+
+void LatexCacheManager::restartFinishedWarmWorkers() {
+    QStringList crashedPreambles;
+    for(auto const& worker: mWarmWorkers) {
+        if(worker.mProcess->state() != QProcess::NotRunning) {
+            continue;
+        }
+        // a worker exiting normally failed on its preamble, the formulas using it report the error
+        if(worker.mProcess->exitStatus() == QProcess::CrashExit) {
+            crashedPreambles.append(worker.mPreamble);
+        }
+        else {
+            qWarning() << "LaTeX worker stopped with exit code" << worker.mProcess->exitCode();
+        }
+    }
+    mWarmWorkers.erase(std::remove_if(mWarmWorkers.begin(), mWarmWorkers.end(),
+                                      [](auto const& worker){return worker.mProcess->state() == QProcess::NotRunning;}),
+                       mWarmWorkers.end());
+    for(auto const& preamble: crashedPreambles) {
+        if(mWorkerRestarts >= maximalWorkerRestarts) {
+            return;
+        }
+        mWorkerRestarts++;
+        if(auto worker = startWarmWorker(preamble)) {
+            mWarmWorkers.push_back(std::move(*worker));
+        }
     }
 }
 
@@ -79,9 +261,16 @@ void LatexCacheManager::startConversionProcess(QString latexInput, ConversionTyp
 SvgEntry LatexCacheManager::getCachedImage(QString latexInput) const{
     const auto it = mCachedImages.find(latexInput);
     if(it == mCachedImages.end()){
+        mMisses++;
         return SvgEntry{SvgStatus::NotStarted, nullptr};
     }
     else{
+        if(it->second.status == SvgStatus::Success || it->second.status == SvgStatus::Error) {
+            mHits++;
+        }
+        else {
+            mMisses++;
+        }
         return it->second;
     }
 }
@@ -104,9 +293,11 @@ void LatexCacheManager::startSvgGeneration(){
         return;
     }
 
-    // latex process failed
+    traceJob(*latexJob, "pdflatex");
+
+    // latex process failed or was killed after the timeout
     qWarning() << "latex exit code " << latexJob->mProcess->errorString();
-    if(latexJob->mProcess->exitCode() != 0){
+    if(latexJob->mProcess->exitStatus() != QProcess::NormalExit || latexJob->mProcess->exitCode() != 0){
         auto exitCode = latexJob->mProcess->exitCode();
         auto error = latexJob->mProcess->readAllStandardError();
         auto out = latexJob->mProcess->readAllStandardOutput();
@@ -121,19 +312,16 @@ void LatexCacheManager::startSvgGeneration(){
     job.mTempDir = std::move(latexJob->mTempDir);
     job.mInput = latexJob->mInput;
     job.mConversionType = latexJob->mConversionType;
+    job.mStartTime = tracer().enabled() ? tracer().now() : -1;
 
-    QString programDvisvgm = "/usr/bin/pdftocairo";
     QStringList argumentsDvisvgm;
 
     argumentsDvisvgm << "-svg" << job.mTempDir->path() + "/input.pdf" << job.mTempDir->path() + "/input.svg" ;
 
     QObject::connect(job.mProcess.get(), QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
                      this, &LatexCacheManager::writeSvgToMap);
-    job.mProcess->start(programDvisvgm, argumentsDvisvgm);
-
-    if(job.mConversionType == BreakUntillFinished) {
-        job.mProcess->waitForFinished(-1);
-    }
+    job.mProcess->start(mPdftocairo, argumentsDvisvgm);
+    watchProcess(job.mProcess.get(), job.mConversionType);
 }
 
 void LatexCacheManager::writeSvgToMap(){
@@ -144,9 +332,15 @@ void LatexCacheManager::writeSvgToMap(){
     }
     if (!dviJob->mTempDir)
         throw;
+    traceJob(*dviJob, "pdftocairo");
+    TraceSpan span("load svg", "latex");
 
+    // pdftocairo failed or was killed after the timeout, a partially written file is not used
     auto file = QFile(dviJob->mTempDir->path() + "/input.svg");
-    if(!file.open(QIODevice::ReadOnly)) {
+    if(dviJob->mProcess->exitStatus() != QProcess::NormalExit || dviJob->mProcess->exitCode() != 0 || !file.open(QIODevice::ReadOnly)) {
+        qWarning() << "pdftocairo error" << dviJob->mProcess->readAllStandardError() << dviJob->mProcess->exitCode();
+        mCachedImages[dviJob->mInput].status = SvgStatus::Error;
+        Q_EMIT conversionFinished();
         return;
     }
     mCachedImages[dviJob->mInput] = SvgEntry{SvgStatus::Success, std::make_shared<QSvgRenderer>(file.readAll())};
@@ -154,6 +348,48 @@ void LatexCacheManager::writeSvgToMap(){
     Q_EMIT conversionFinished();
 }
 
+void LatexCacheManager::traceJob(Job const& job, char const* stage) const {
+    if(job.mStartTime >= 0) {
+        tracer().record(stage, "latex", job.mStartTime, tracer().now());
+    }
+}
+
 void LatexCacheManager::resetCache() {
     mCachedImages.clear();
+    // files included by the preambles may have changed
+    for(auto& worker: mWarmWorkers) {
+        stopWarmWorker(worker);
+    }
+    mWarmWorkers.clear();
+    mPreambleUses.clear();
+    mWorkerRestarts = 0;
+}
+
+int LatexCacheManager::numberOfPendingJobs() const {
+    return int(mRunningLatexJobs.size() + mRunningPdfToSvgJobs.size());
+}
+
+void LatexCacheManager::setStubConversion(bool stub) {
+    mStubConversion = stub;
+}
+
+CacheStatistics LatexCacheManager::statistics() const {
+    return {mHits, mMisses};
+}
+
+void LatexCacheManager::setNumberOfWarmWorkers(int number) {
+    mNumberOfWarmWorkers = number;
+    while(int(mWarmWorkers.size()) > std::max(number, 0)) {
+        stopWarmWorker(mWarmWorkers.front());
+        mWarmWorkers.erase(mWarmWorkers.begin());
+    }
+}
+
+void LatexCacheManager::setConversionTimeout(int milliseconds) {
+    mConversionTimeout = milliseconds;
+}
+
+void LatexCacheManager::setPrograms(QString const& pdflatex, QString const& pdftocairo) {
+    mPdflatex = pdflatex;
+    mPdftocairo = pdftocairo;
 }
@@ -12,8 +12,10 @@
 #include <QFile>
 #include <QTemporaryDir>
 
+#include <atomic>
 #include <memory>
 #include <optional>
+#include "cachemanager.h"
 
 enum SvgStatus{
     Success,
@@ -41,6 +43,15 @@ struct Job {
     std::unique_ptr<QTemporaryDir> mTempDir;
     QString mInput;
     ConversionType mConversionType = NoBreak;
+    // start of the process for tracing, -1 if tracing is disabled
+    qint64 mStartTime = -1;
+};
+
+// pdflatex process which has loaded a preamble and waits for the body of the document
+struct WarmWorker {
+    std::unique_ptr<QProcess, DelayedDelete> mProcess;
+    std::unique_ptr<QTemporaryDir> mTempDir;
+    QString mPreamble;
 };
 
 class LatexCacheManager : public QObject
@@ -54,17 +65,51 @@ public:
     void startSvgGeneration();
     void writeSvgToMap();
     void resetCache();
+    // number of LaTeX processes that are still running
+    int numberOfPendingJobs() const;
+    // conversions finish immediately with an empty image instead of running LaTeX,
+    // e.g. for benchmarks on machines without a TeX installation
+    void setStubConversion(bool stub);
+    // a lookup is a hit if the conversion of the input has finished
+    CacheStatistics statistics() const;
+    // number of pdflatex processes loading the preambles of the latest formulas in advance,
+    // with 0 a fresh process is started for every formula
+    void setNumberOfWarmWorkers(int number);
+    // processes running longer are killed and their conversion fails
+    void setConversionTimeout(int milliseconds);
+    // paths of pdflatex and pdftocairo, e.g. stubs in tests
+    void setPrograms(QString const& pdflatex, QString const& pdftocairo);
 
 Q_SIGNALS:
     void conversionFinished();
 
 private:
     std::optional<Job> takeOneFinishedJob(std::vector<Job>& jobs);
+    void traceJob(Job const& job, char const* stage) const;
+    void watchProcess(QProcess* process, ConversionType conversionType) const;
+    std::optional<WarmWorker> startWarmWorker(QString const& preamble);
+    std::optional<WarmWorker> takeWarmWorker(QString const& preamble);
+    void prepareWarmWorker(QString const& preamble);
+    void stopWarmWorker(WarmWorker& worker);
+    void restartFinishedWarmWorkers();
+    bool startWarmJob(WarmWorker worker, QString const& body, QString const& latexInput, ConversionType conversionType);
 
 private:
     std::unordered_map<QString, SvgEntry> mCachedImages;
     std::vector<Job> mRunningLatexJobs;
     std::vector<Job> mRunningPdfToSvgJobs;
+    // idle workers, the oldest first
+    std::vector<WarmWorker> mWarmWorkers;
+    // number of conversions by preamble, workers load a preamble in advance once it was used twice
+    std::unordered_map<QString, int> mPreambleUses;
+    int mNumberOfWarmWorkers = 2;
+    int mWorkerRestarts = 0;
+    int mConversionTimeout = 30000;
+    bool mStubConversion = false;
+    QString mPdflatex = "/usr/bin/pdflatex";
+    QString mPdftocairo = "/usr/bin/pdftocairo";
+    mutable std::atomic<qint64> mHits = 0;
+    mutable std::atomic<qint64> mMisses = 0;
 };
 
 LatexCacheManager& cacheManager();
@@ -0,0 +1,172 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "latexcachemanagertest.h"
+#include "latexcachemanager.h"
+
+#include <QSignalSpy>
+
+QTEST_MAIN(LatexCacheManagerTest)
+
+namespace {
+// writes the arguments of every start to the file launches, warm workers wait for a line on stdin
+auto const pdflatexStub = QByteArray(R"(#!/bin/sh
+echo "$*" >> "$POTATO_STUB_DIR/launches"
+case "$POTATO_STUB_LATEX" in
+    fail) exit 1 ;;
+    crash) kill -SEGV $$ ;;
+    hang) exec sleep 30 ;;
+esac
+case "$*" in
+    *scrollmode*) read line || exit 1 ;;
+esac
+exit 0
+)");
+
+auto const pdftocairoStub = QByteArray(R"(#!/bin/sh
+case "$POTATO_STUB_SVG" in
+    fail) exit 1 ;;
+    crash) kill -SEGV $$ ;;
+    missing) exit 0 ;;
+esac
+echo '<svg xmlns="http://www.w3.org/2000/svg" width="10" height="10"/>' > "$3"
+)");
+
+auto const preamble = QString("\\documentclass{article}\\begin{document}");
+
+bool writeStub(QString const& path, QByteArray const& script) {
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(script);
+    file.close();
+    return file.setPermissions(file.permissions() | QFileDevice::ExeOwner);
+}
+
+int numberOfLaunches(QString const& directory) {
+    QFile file(directory + "/launches");
+    if(!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    return file.readAll().count('\n');
+}
+
+void setupManager(LatexCacheManager& manager, QString const& directory, int warmWorkers) {
+    manager.setPrograms(directory + "/pdflatex", directory + "/pdftocairo");
+    manager.setNumberOfWarmWorkers(warmWorkers);
+}
+}
+
+void LatexCacheManagerTest::initTestCase() {
+#ifndef Q_OS_UNIX
+    QSKIP("The stubs are shell scripts.");
+#endif
+    QVERIFY(mDirectory.isValid());
+    QVERIFY(writeStub(mDirectory.filePath("pdflatex"), pdflatexStub));
+    QVERIFY(writeStub(mDirectory.filePath("pdftocairo"), pdftocairoStub));
+    qputenv("POTATO_STUB_DIR", mDirectory.path().toUtf8());
+}
+
+void LatexCacheManagerTest::init() {
+    qunsetenv("POTATO_STUB_LATEX");
+    qunsetenv("POTATO_STUB_SVG");
+    QFile::remove(mDirectory.filePath("launches"));
+}
+
+void LatexCacheManagerTest::testSuccess() {
+    LatexCacheManager manager;
+    setupManager(manager, mDirectory.path(), 0);
+    QSignalSpy finished(&manager, &LatexCacheManager::conversionFinished);
+    manager.startConversionProcess("formula");
+    QTRY_COMPARE(finished.count(), 1);
+    auto const entry = manager.getCachedImage("formula");
+    QCOMPARE(entry.status, SvgStatus::Success);
+    QVERIFY(entry.svg && entry.svg->isValid());
+}
+
+void LatexCacheManagerTest::testFailure() {
+    QFETCH(QByteArray, latex);
+    QFETCH(QByteArray, svg);
+    qputenv("POTATO_STUB_LATEX", latex);
+    qputenv("POTATO_STUB_SVG", svg);
+    LatexCacheManager manager;
+    setupManager(manager, mDirectory.path(), 0);
+    QSignalSpy finished(&manager, &LatexCacheManager::conversionFinished);
+    manager.startConversionProcess("formula");
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(manager.getCachedImage("formula").status, SvgStatus::Error);
+    QCOMPARE(manager.numberOfPendingJobs(), 0);
+}
+
+void LatexCacheManagerTest::testFailure_data() {
+    QTest::addColumn<QByteArray>("latex");
+    QTest::addColumn<QByteArray>("svg");
+    QTest::newRow("pdflatex fails") << QByteArray("fail") << QByteArray();
+    QTest::newRow("pdflatex crashes") << QByteArray("crash") << QByteArray();
+    QTest::newRow("pdftocairo fails") << QByteArray() << QByteArray("fail");
+    QTest::newRow("pdftocairo crashes") << QByteArray() << QByteArray("crash");
+    QTest::newRow("svg missing") << QByteArray() << QByteArray("missing");
+}
+
+void LatexCacheManagerTest::testTimeout() {
+    qputenv("POTATO_STUB_LATEX", "hang");
+    LatexCacheManager manager;
+    setupManager(manager, mDirectory.path(), 0);
+    manager.setConversionTimeout(200);
+    QSignalSpy finished(&manager, &LatexCacheManager::conversionFinished);
+    manager.startConversionProcess("formula");
+    QCOMPARE(manager.getCachedImage("formula").status, SvgStatus::Pending);
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 5000);
+    QCOMPARE(manager.getCachedImage("formula").status, SvgStatus::Error);
+
+    // the conversions which block wait for the timeout
+    manager.startConversionProcess("blocking", BreakUntillFinished);
+    QCOMPARE(manager.getCachedImage("blocking").status, SvgStatus::Error);
+}
+
+void LatexCacheManagerTest::testWarmWorkers() {
+    LatexCacheManager manager;
+    setupManager(manager, mDirectory.path(), 1);
+    QSignalSpy finished(&manager, &LatexCacheManager::conversionFinished);
+    // a preamble used once is not loaded in advance
+    manager.startConversionProcess(preamble + "a");
+    QTRY_COMPARE(finished.count(), 1);
+    QTRY_COMPARE(numberOfLaunches(mDirectory.path()), 1);
+
+    // the second formula loads the preamble for the next one
+    manager.startConversionProcess(preamble + "b");
+    QTRY_COMPARE(finished.count(), 2);
+    QTRY_COMPARE(numberOfLaunches(mDirectory.path()), 3);
+    manager.startConversionProcess(preamble + "c");
+    QTRY_COMPARE(finished.count(), 3);
+    QTRY_COMPARE(numberOfLaunches(mDirectory.path()), 4);
+    for(auto const& body : {"a", "b", "c"}) {
+        QCOMPARE(manager.getCachedImage(preamble + body).status, SvgStatus::Success);
+    }
+
+    // without warm workers every formula starts its own process
+    manager.setNumberOfWarmWorkers(0);
+    manager.startConversionProcess(preamble + "d");
+    QTRY_COMPARE(finished.count(), 4);
+    QTRY_COMPARE(numberOfLaunches(mDirectory.path()), 5);
+}
+
+void LatexCacheManagerTest::testRestartCrashedWorkers() {
+    qputenv("POTATO_STUB_LATEX", "crash");
+    LatexCacheManager manager;
+    setupManager(manager, mDirectory.path(), 1);
+    QSignalSpy finished(&manager, &LatexCacheManager::conversionFinished);
+    manager.startConversionProcess(preamble + "a");
+    manager.startConversionProcess(preamble + "b");
+    QTRY_COMPARE(finished.count(), 2);
+    QCOMPARE(manager.getCachedImage(preamble + "a").status, SvgStatus::Error);
+    QCOMPARE(manager.getCachedImage(preamble + "b").status, SvgStatus::Error);
+    // two formulas, the worker loading the preamble in advance and three restarts of it
+    QTRY_COMPARE(numberOfLaunches(mDirectory.path()), 6);
+    QTest::qWait(300);
+    QCOMPARE(numberOfLaunches(mDirectory.path()), 6);
+}
@@ -0,0 +1,32 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef LATEXCACHEMANAGERTEST_H
+#define LATEXCACHEMANAGERTEST_H
+
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+
+// Runs the conversions with shell scripts instead of pdflatex and pdftocairo,
+// their behaviour is chosen with environment variables.
+class LatexCacheManagerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void testSuccess();
+    void testFailure();
+    void testFailure_data();
+    void testTimeout();
+    void testWarmWorkers();
+    void testRestartCrashedWorkers();
+
+private:
+    QTemporaryDir mDirectory;
+};
+
+#endif // LATEXCACHEMANAGERTEST_H
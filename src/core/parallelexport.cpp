@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "parallelexport.h"
+#include "sliderenderer.h"
+#include "tracing.h"
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+namespace {
+class PageChunkJob : public QRunnable
+{
+public:
+    PageChunkJob(std::size_t chunk, std::vector<QPicture> pages, PageChunkConsumer const& consume, QSemaphore& pendingChunks)
+        : mChunk(chunk)
+        , mPages(std::move(pages))
+        , mConsume(consume)
+        , mPendingChunks(pendingChunks)
+    {
+    }
+
+    void run() override {
+        mConsume(mChunk, mPages);
+        mPages.clear();
+        mPendingChunks.release();
+    }
+
+private:
+    std::size_t mChunk;
+    std::vector<QPicture> mPages;
+    PageChunkConsumer const& mConsume;
+    QSemaphore& mPendingChunks;
+};
+}
+
+void recordPagesInParallel(std::vector<std::vector<ExportPage>> const& chunks, ParallelExportOptions const& options,
+                           PageChunkConsumer const& consume) {
+    QThreadPool pool;
+    if(options.threads > 0) {
+        pool.setMaxThreadCount(options.threads);
+    }
+    QSemaphore pendingChunks(2 * pool.maxThreadCount());
+    for(std::size_t chunk = 0; chunk < chunks.size(); chunk++) {
+        std::vector<QPicture> pages;
+        for(auto const& [slide, pause] : chunks[chunk]) {
+            TraceSpan span("record page", "export");
+            QPicture picture;
+            QPainter painter(&picture);
+            auto renderer = SlideRenderer::exportRenderer(painter, options.additionalRenderHints);
+            renderer.setMaximalImageResolution(options.maximalImageResolution);
+            renderer.setImageFileEmbedder(options.imageFileEmbedder);
+            renderer.paintSlide(slide, pause);
+            painter.end();
+            pages.push_back(std::move(picture));
+        }
+        pendingChunks.acquire();
+        pool.start(new PageChunkJob(chunk, std::move(pages), consume, pendingChunks));
+    }
+    pool.waitForDone();
+}
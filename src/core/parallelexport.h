@@ -0,0 +1,41 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef PARALLELEXPORT_H
+#define PARALLELEXPORT_H
+
+#include "slide.h"
+
+#include <QPicture>
+#include <functional>
+
+// a page of an export, the slide and the pause shown on it
+struct ExportPage {
+    Slide::Ptr slide;
+    int pause;
+};
+
+struct ParallelExportOptions {
+    // in addition to the hints of SlideRenderer::exportRenderer
+    PresentationRenderHints additionalRenderHints = NoRenderHints;
+    // images with more pixels per slide unit are downsampled, 0 draws them in the resolution of their files
+    double maximalImageResolution = 0;
+    // image files are drawn as placeholders of the embedder, nullptr draws the images
+    ImageFileEmbedder* imageFileEmbedder = nullptr;
+    // number of threads, 0 for one per core
+    int threads = 0;
+};
+
+// receives the recorded pages of a chunk with the index of the chunk, it is called in the thread pool
+using PageChunkConsumer = std::function<void(std::size_t chunk, std::vector<QPicture> const& pages)>;
+
+// Records the pages of every chunk and passes them to consume in a thread pool, e.g. to rasterize
+// or write them. The boxes are drawn in the calling thread, the caches of images and LaTeX formulas
+// are not thread-safe. Recorded pages can hold full resolution images, so only a few chunks wait for a thread.
+void recordPagesInParallel(std::vector<std::vector<ExportPage>> const& chunks, ParallelExportOptions const& options,
+                           PageChunkConsumer const& consume);
+
+#endif // PARALLELEXPORT_H
@@ -11,6 +11,7 @@
 #include <QJsonValue>
 #include <QCryptographicHash>
 #include <charconv>
+#include <optional>
 #include <QDir>
 #include <QRegularExpression>
 #include <QDate>
@@ -21,14 +22,21 @@
 #include "potatoParser.h"
 #include "potatoformatvisitor.h"
 #include "potatoerrorlistener.h"
+#include "tracing.h"
 
 ParserOutput generateSlides(std::string text, QString directory, bool isTemplate) {
+    TraceSpan generateSpan("generateSlides", "parser");
+    std::optional<TraceSpan> inputSpan(std::in_place, "read input", "parser");
     std::istringstream str(text);
     antlr4::ANTLRInputStream input(str);
     potatoLexer lexer(&input);
     antlr4::CommonTokenStream tokens(&lexer);
+    inputSpan.reset();
 
-    tokens.fill();
+    {
+        TraceSpan span("tokens.fill", "parser");
+        tokens.fill();
+    }
     potatoParser parser(&tokens);
     parser.getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(antlr4::atn::PredictionMode::SLL);
 
@@ -36,7 +44,11 @@ ParserOutput generateSlides(std::string text, QString directory, bool isTemplate
     PotatoErrorListener errorListener;
     parser.addErrorListener(&errorListener); // add ours
 
-    antlr4::tree::ParseTree *tree = parser.potato();
+    antlr4::tree::ParseTree *tree = nullptr;
+    {
+        TraceSpan span("parse", "parser");
+        tree = parser.potato();
+    }
     if(!errorListener.success()) {
         auto const error = errorListener.error();
         return ParserError{error.message, int(error.line)-1};
@@ -46,6 +58,7 @@ ParserOutput generateSlides(std::string text, QString directory, bool isTemplate
     listener.setDirectory(directory);
     listener.setParseTemplate(isTemplate);
     try {
+        TraceSpan span("tree walk", "parser");
         auto walker = antlr4::tree::ParseTreeWalker();
         walker.walk(&listener, tree);
         return ParserOutput(listener.slides(), listener.preamble());
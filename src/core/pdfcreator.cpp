@@ -5,9 +5,54 @@
 */
 
 #include "pdfcreator.h"
+#include "displaylistcache.h"
+#include "imagebox.h"
+#include "parallelexport.h"
+#include "pdfmerger.h"
 #include "sliderenderer.h"
+#include "tracing.h"
 
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QImage>
 #include <QPdfWriter>
+#include <QPicture>
+#include <QTemporaryDir>
+
+namespace {
+// a document written by one thread holds about this number of slides, and at most maximalPagesPerChunk pages
+constexpr int slidesPerChunk = 8;
+constexpr std::size_t maximalPagesPerChunk = 32;
+
+void setupPdfWriter(QPdfWriter& pdfWriter, QString const& title) {
+    pdfWriter.setPageSize(QPageSize(QSizeF(167.0625, 297), QPageSize::Millimeter));
+    pdfWriter.setPageOrientation(QPageLayout::Landscape);
+    pdfWriter.setPageMargins(QMargins(0, 0, 0, 0));
+    pdfWriter.setTitle(title);
+}
+
+// writes the pages into a document of their own, which is merged with the others
+QByteArray writeDocument(std::vector<QPicture> const& pages, QSize dimensions) {
+    TraceSpan span("pdf chunk", "pdf");
+    QByteArray document;
+    QBuffer buffer(&document);
+    buffer.open(QIODevice::WriteOnly);
+    {
+        QPdfWriter pdfWriter(&buffer);
+        setupPdfWriter(pdfWriter, {});
+        QPainter painter(&pdfWriter);
+        painter.setWindow(QRect(QPoint(0, 0), dimensions));
+        for(std::size_t page = 0; page < pages.size(); page++) {
+            painter.drawPicture(0, 0, pages[page]);
+            if(page + 1 < pages.size()) {
+                pdfWriter.newPage();
+            }
+        }
+    }
+    return document;
+}
+}
 
 PDFCreator::PDFCreator()
 {
@@ -15,20 +60,19 @@ PDFCreator::PDFCreator()
 
 
 void PDFCreator::createPdf(QString filename, std::shared_ptr<Presentation> presentation) const{
+    TraceSpan span("createPdf", "pdf");
     QPdfWriter pdfWriter(filename);
-    pdfWriter.setPageSize(QPageSize(QSizeF(167.0625, 297), QPageSize::Millimeter));
-    pdfWriter.setPageOrientation(QPageLayout::Landscape);
-    pdfWriter.setPageMargins(QMargins(0, 0, 0, 0));
-    pdfWriter.setTitle(presentation->title());
+    setupPdfWriter(pdfWriter, presentation->title());
 
     QPainter painter(&pdfWriter);
 
     painter.begin(&pdfWriter);
     painter.setWindow(QRect(QPoint(0, 0), presentation->dimensions()));
-    auto paint = std::make_shared<SlideRenderer>(painter);
-    paint->setRenderHints(static_cast<PresentationRenderHints>(static_cast<int>(TargetIsVectorSurface) | static_cast<int>(NoPreviewRendering)));
+    auto paint = std::make_shared<SlideRenderer>(SlideRenderer::exportRenderer(painter));
+    paint->setMaximalImageResolution(maximalImageResolution(*presentation));
     for(auto &slide: presentation->data().slideListDefaultApplied().vector){
         for( int i = 0; i <= slide->numberPauses(); i++) {
+            TraceSpan pageSpan("pdf page", "pdf");
             paint->paintSlide(slide, i);
             if(!(slide == presentation->data().slideListDefaultApplied().vector.back() && i == slide->numberPauses())){
                 pdfWriter.newPage();
@@ -39,18 +83,19 @@ void PDFCreator::createPdf(QString filename, std::shared_ptr<Presentation> prese
 }
 
 void PDFCreator::createPdfHandout(QString filename, std::shared_ptr<Presentation> presentation) const{
+    TraceSpan span("createPdfHandout", "pdf");
     QPdfWriter pdfWriter(filename);
-    pdfWriter.setPageSize(QPageSize(QSizeF(167.0625, 297), QPageSize::Millimeter));
-    pdfWriter.setPageOrientation(QPageLayout::Landscape);
-    pdfWriter.setPageMargins(QMargins(0, 0, 0, 0));
-    pdfWriter.setTitle(presentation->title());
+    setupPdfWriter(pdfWriter, presentation->title());
 
     QPainter painter(&pdfWriter);
 
     painter.begin(&pdfWriter);
     painter.setWindow(QRect(QPoint(0, 0), presentation->dimensions()));
     auto paint = std::make_shared<SlideRenderer>(painter);
+    // the slides are drawn with the hints of the previews and share their recordings
+    paint->setDisplayListCache(&displayListCache());
     for(auto &slide: presentation->data().slideListDefaultApplied().vector){
+        TraceSpan pageSpan("pdf page", "pdf");
         paint->paintSlide(slide);
         if(slide != presentation->data().slideListDefaultApplied().vector.back()){
             pdfWriter.newPage();
@@ -58,3 +103,131 @@ void PDFCreator::createPdfHandout(QString filename, std::shared_ptr<Presentation
     }
     painter.end();
 }
+
+void PDFCreator::createPdfParallel(QString filename, std::shared_ptr<Presentation> presentation, int threads) {
+    TraceSpan span("createPdfParallel", "pdf");
+    // Chunks end after slides selected by their fingerprint, so an edit moves the boundaries
+    // of at most the chunk around the edited slide and the other chunks are reused.
+    struct Chunk {
+        std::vector<ExportPage> pages;
+        QByteArray fingerprint;
+    };
+    std::vector<Chunk> chunks;
+    // the merged document contains JPEG files without decoding them
+    auto const embedJpegFiles = placeholdersWork(presentation->dimensions());
+    {
+        TraceSpan fingerprintSpan("fingerprint pages", "pdf");
+        Chunk chunk;
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        // documents written with another image resolution or with the images instead of placeholders are not reused
+        auto const settings = QByteArray::number(mMaximalImageDpi) + (embedJpegFiles ? " jpeg" : "");
+        hash.addData(settings);
+        for(auto const& slide : presentation->data().slideListDefaultApplied().vector) {
+            auto const fingerprint = slide->fingerprint();
+            for(int pause = 0; pause <= slide->numberPauses(); pause++) {
+                chunk.pages.push_back({slide, pause});
+                hash.addData(fingerprint + QByteArray::number(pause));
+            }
+            if(chunk.pages.size() >= maximalPagesPerChunk || quint8(fingerprint.back()) % slidesPerChunk == 0) {
+                chunk.fingerprint = hash.result();
+                chunks.push_back(std::move(chunk));
+                chunk = {};
+                hash.reset();
+                hash.addData(settings);
+            }
+        }
+        if(!chunk.pages.empty()) {
+            chunk.fingerprint = hash.result();
+            chunks.push_back(std::move(chunk));
+        }
+    }
+
+    std::vector<QByteArray> documents(chunks.size());
+    // chunks which are not reused and their index in documents
+    std::vector<std::vector<ExportPage>> changedChunks;
+    std::vector<std::size_t> changedDocuments;
+    for(std::size_t index = 0; index < chunks.size(); index++) {
+        auto const cached = mChunks.find(chunks[index].fingerprint);
+        if(cached != mChunks.end()) {
+            documents[index] = cached->second;
+            continue;
+        }
+        changedChunks.push_back(chunks[index].pages);
+        changedDocuments.push_back(index);
+    }
+    mJpegFiles.beginExport();
+    ParallelExportOptions options;
+    options.imageFileEmbedder = embedJpegFiles ? &mJpegFiles : nullptr;
+    options.maximalImageResolution = maximalImageResolution(*presentation);
+    options.threads = threads;
+    auto const dimensions = presentation->dimensions();
+    recordPagesInParallel(changedChunks, options, [&](std::size_t chunk, std::vector<QPicture> const& pages) {
+        documents[changedDocuments[chunk]] = writeDocument(pages, dimensions);
+    });
+
+    // only the documents of this export are kept
+    mChunks.clear();
+    for(std::size_t index = 0; index < chunks.size(); index++) {
+        mChunks[chunks[index].fingerprint] = documents[index];
+    }
+
+    auto const merged = mergePdfs(documents, presentation->title(), embedJpegFiles ? &mJpegFiles : nullptr);
+    QFile file(filename);
+    if(!merged || !file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        mChunks.clear();
+        mJpegFiles.clear();
+        createPdf(filename, presentation);
+        return;
+    }
+    file.write(*merged);
+    mJpegFiles.releaseUnused();
+}
+
+void PDFCreator::resetExportCache() {
+    mChunks.clear();
+    mJpegFiles.clear();
+}
+
+void PDFCreator::setMaximalImageDpi(int dpi) {
+    mMaximalImageDpi = dpi;
+}
+
+double PDFCreator::maximalImageResolution(Presentation const& presentation) const {
+    if(mMaximalImageDpi <= 0) {
+        return 0;
+    }
+    // the page is 297mm wide
+    return mMaximalImageDpi * 297 / 25.4 / presentation.dimensions().width();
+}
+
+bool PDFCreator::placeholdersWork(QSize dimensions) {
+    // The image objects QPdfWriter writes are not documented. A slide with a JPEG file is exported
+    // like the presentation once and the merged document has to contain the file.
+    static std::optional<bool> works;
+    if(!works) {
+        works = false;
+        QTemporaryDir directory;
+        auto const path = directory.filePath("placeholder.jpg");
+        QImage image(64, 48, QImage::Format_RGB32);
+        image.fill(Qt::red);
+        if(!directory.isValid() || !image.save(path, "jpg")) {
+            return false;
+        }
+        auto box = std::make_shared<ImageBox>();
+        box->style().mText = path;
+        box->setGeometry(BoxGeometry(QRect(QPoint(0, 0), dimensions), 0));
+        auto slide = std::make_shared<Slide>("placeholder", 0);
+        slide->appendBox(box);
+
+        PdfJpegFiles files;
+        files.beginExport();
+        ParallelExportOptions options;
+        options.imageFileEmbedder = &files;
+        std::vector<QByteArray> documents(1);
+        recordPagesInParallel({{ExportPage{slide, 0}}}, options, [&](std::size_t, std::vector<QPicture> const& pages) {
+            documents.front() = writeDocument(pages, dimensions);
+        });
+        works = mergePdfs(documents, {}, &files).has_value() && files.replacedFiles() == 1;
+    }
+    return *works;
+}
@@ -9,7 +9,9 @@
 
 #include <QString>
 #include <QPainter>
+#include <map>
 
+#include "pdfmerger.h"
 #include "presentation.h"
 
 class PDFCreator
@@ -18,6 +20,27 @@ public:
     PDFCreator();
     void createPdf(QString filename, std::shared_ptr<Presentation> presentation) const;
     void createPdfHandout(QString filename, std::shared_ptr<Presentation> presentation) const;
+    // Writes chunks of pages into separate documents in a thread pool and merges them.
+    // Chunks whose pages have the same fingerprints as in the last call are reused instead of rendered again.
+    // JPEG files which need no resampling are embedded unchanged. Falls back to createPdf if the documents cannot be merged.
+    void createPdfParallel(QString filename, std::shared_ptr<Presentation> presentation, int threads = 0);
+    // forget the documents and JPEG files of the last export, e.g. when the resources are reloaded
+    void resetExportCache();
+    // images with a higher resolution on the page are downsampled, 0 embeds the image files unchanged
+    void setMaximalImageDpi(int dpi);
+
+private:
+    // pixels per slide unit of the images on pages with the width of the presentation
+    double maximalImageResolution(Presentation const& presentation) const;
+    // whether the placeholders of JPEG files are found in the documents of the export
+    bool placeholdersWork(QSize dimensions);
+
+private:
+    int mMaximalImageDpi = 0;
+    // documents of the last export by the fingerprint of their pages
+    std::map<QByteArray, QByteArray> mChunks;
+    // JPEG files in the documents of the last export
+    PdfJpegFiles mJpegFiles;
 };
 
 #endif // PDFCREATOR_H
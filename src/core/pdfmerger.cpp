@@ -0,0 +1,571 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "pdfmerger.h"
+#include "tracing.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <numeric>
+
+namespace {
+
+struct PdfObject {
+    // dictionary or value of the object, it contains the references
+    QByteArray value;
+    std::optional<QByteArray> stream;
+};
+
+struct PdfDocument {
+    std::map<int, PdfObject> objects;
+    int catalog = 0;
+    int pageTree = 0;
+    int info = 0;
+    std::vector<int> pages;
+};
+
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\0';
+}
+
+std::optional<int> readInt(QByteArray const& data, int& position) {
+    while(position < data.size() && isWhitespace(data[position])) {
+        position++;
+    }
+    auto const start = position;
+    while(position < data.size() && data[position] >= '0' && data[position] <= '9') {
+        position++;
+    }
+    if(start == position) {
+        return {};
+    }
+    return data.mid(start, position - start).toInt();
+}
+
+bool isDelimiter(char c) {
+    return isWhitespace(c) || QByteArray("()<>[]{}/%").contains(c);
+}
+
+// position of the name, e.g. /Length, which is not only the start of a longer name like /Length1
+int indexOfName(QByteArray const& data, QByteArray const& name, int from = 0) {
+    for(auto index = data.indexOf(name, from); index >= 0; index = data.indexOf(name, index + 1)) {
+        auto const end = index + name.size();
+        if(end == data.size() || isDelimiter(data[end])) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+bool containsName(QByteArray const& data, QByteArray const& name) {
+    return indexOfName(data, name) >= 0;
+}
+
+// integer or the object number of the reference following key, e.g. /Root 1 0 R
+std::optional<int> valueOf(QByteArray const& dictionary, QByteArray const& key) {
+    auto const index = indexOfName(dictionary, key);
+    if(index < 0) {
+        return {};
+    }
+    auto position = int(index + key.size());
+    return readInt(dictionary, position);
+}
+
+bool isReference(QByteArray const& dictionary, QByteArray const& key) {
+    static QRegularExpression const reference("^\\s*\\d+\\s+\\d+\\s+R");
+    auto const index = indexOfName(dictionary, key);
+    return index >= 0 && reference.match(QString::fromLatin1(dictionary.mid(index + key.size(), 32))).hasMatch();
+}
+
+std::vector<int> references(QByteArray const& array) {
+    static QRegularExpression const reference("(\\d+)\\s+\\d+\\s+R");
+    std::vector<int> numbers;
+    auto matches = reference.globalMatch(QString::fromLatin1(array));
+    while(matches.hasNext()) {
+        numbers.push_back(matches.next().captured(1).toInt());
+    }
+    return numbers;
+}
+
+// replaces the object numbers of all references in value
+QByteArray renumber(QByteArray const& value, std::function<int(int)> const& number) {
+    static QRegularExpression const reference("(?<![\\d.])(\\d+)\\s+(\\d+)\\s+R(?![A-Za-z])");
+    auto const text = QString::fromLatin1(value);
+    QByteArray result;
+    result.reserve(value.size());
+    int last = 0;
+    auto matches = reference.globalMatch(text);
+    while(matches.hasNext()) {
+        auto const match = matches.next();
+        result.append(value.mid(last, match.capturedStart() - last));
+        auto const target = number(match.captured(1).toInt());
+        result.append(target > 0 ? QByteArray::number(target) + " 0 R" : QByteArray("null"));
+        last = match.capturedEnd();
+    }
+    result.append(value.mid(last));
+    return result;
+}
+
+std::optional<PdfDocument> readDocument(QByteArray const& data) {
+    auto const startxref = data.lastIndexOf("startxref");
+    if(startxref < 0) {
+        return {};
+    }
+    auto position = int(startxref + 9);
+    auto const xref = readInt(data, position);
+    if(!xref || !data.mid(*xref, 4).startsWith("xref")) {
+        return {};
+    }
+
+    // cross-reference table: subsections of "<first> <count>" followed by "<offset> <generation> n|f"
+    std::map<int, int> offsets;
+    position = *xref + 4;
+    while(true) {
+        auto const first = readInt(data, position);
+        if(!first) {
+            break;
+        }
+        auto const count = readInt(data, position);
+        if(!count) {
+            return {};
+        }
+        for(int entry = 0; entry < *count; entry++) {
+            auto const offset = readInt(data, position);
+            auto const generation = readInt(data, position);
+            while(position < data.size() && isWhitespace(data[position])) {
+                position++;
+            }
+            if(!offset || !generation || position >= data.size()) {
+                return {};
+            }
+            if(data[position] == 'n' && *first + entry > 0) {
+                offsets[*first + entry] = *offset;
+            }
+            position++;
+        }
+    }
+    auto const trailerStart = data.indexOf("trailer", position);
+    if(trailerStart < 0) {
+        return {};
+    }
+    auto const trailer = data.mid(trailerStart, startxref - trailerStart);
+    // objects of hybrid documents are partly in compressed object streams, the streams of encrypted ones cannot be compared
+    if(containsName(trailer, "/XRefStm") || containsName(trailer, "/Encrypt")) {
+        return {};
+    }
+
+    PdfDocument document;
+    document.catalog = valueOf(trailer, "/Root").value_or(0);
+    document.info = valueOf(trailer, "/Info").value_or(0);
+
+    // an object ends where the next one or the cross-reference table starts
+    std::vector<int> starts;
+    for(auto const& [number, offset] : offsets) {
+        starts.push_back(offset);
+    }
+    starts.push_back(*xref);
+    std::sort(starts.begin(), starts.end());
+    for(auto const& [number, offset] : offsets) {
+        auto const end = *std::upper_bound(starts.begin(), starts.end(), offset);
+        auto const span = data.mid(offset, end - offset);
+        auto const header = span.indexOf("obj");
+        auto const footer = span.lastIndexOf("endobj");
+        if(header < 0 || footer < header) {
+            return {};
+        }
+        auto const content = span.mid(header + 3, footer - header - 3);
+        PdfObject object;
+        auto const streamStart = content.indexOf("stream");
+        if(streamStart >= 0 && content.left(streamStart).trimmed().endsWith(">>")) {
+            object.value = content.left(streamStart).trimmed();
+            auto dataStart = streamStart + 6;
+            if(content.mid(dataStart, 2) == "\r\n") {
+                dataStart += 2;
+            }
+            else if(content[dataStart] == '\n') {
+                dataStart++;
+            }
+            // the length is resolved when all objects are read
+            object.stream = content.mid(dataStart, content.lastIndexOf("endstream") - dataStart);
+        }
+        else {
+            object.value = content.trimmed();
+        }
+        if(containsName(object.value, "/ObjStm")) {
+            return {};
+        }
+        document.objects[number] = object;
+    }
+
+    // cut the streams to their length, the end of line before endstream is not part of the stream
+    for(auto& [number, object] : document.objects) {
+        if(!object.stream) {
+            continue;
+        }
+        auto length = valueOf(object.value, "/Length");
+        if(length && isReference(object.value, "/Length")) {
+            auto const lengthObject = document.objects.find(*length);
+            length = lengthObject == document.objects.end() ? std::nullopt : std::optional<int>(lengthObject->second.value.trimmed().toInt());
+        }
+        if(!length || *length > object.stream->size()) {
+            return {};
+        }
+        object.stream->truncate(*length);
+    }
+
+    auto const catalog = document.objects.find(document.catalog);
+    if(catalog == document.objects.end()) {
+        return {};
+    }
+    document.pageTree = valueOf(catalog->second.value, "/Pages").value_or(0);
+    auto const pageTree = document.objects.find(document.pageTree);
+    if(pageTree == document.objects.end()) {
+        return {};
+    }
+    // QPdfWriter writes all pages as kids of the page tree
+    auto const& kids = pageTree->second.value;
+    auto const kidsStart = indexOfName(kids, "/Kids");
+    auto const arrayStart = kids.indexOf('[', kidsStart);
+    auto const arrayEnd = kids.indexOf(']', arrayStart);
+    if(kidsStart < 0 || arrayStart < 0 || arrayEnd < 0) {
+        return {};
+    }
+    document.pages = references(kids.mid(arrayStart, arrayEnd - arrayStart));
+    auto const missing = [&document](int page){return document.objects.find(page) == document.objects.end();};
+    if(std::any_of(document.pages.begin(), document.pages.end(), missing)) {
+        return {};
+    }
+    return document;
+}
+
+QByteArray pdfString(QString const& text) {
+    // UTF-16BE with byte order mark
+    QByteArray hex = "<FEFF";
+    for(auto const c : text) {
+        hex += QByteArray::number(c.unicode(), 16).rightJustified(4, '0').toUpper();
+    }
+    return hex + ">";
+}
+
+// "PJPG" followed by the index of the file, as bits of a 64x1 monochrome image
+constexpr quint32 placeholderMagic = 0x504a5047;
+constexpr int placeholderWidth = 64;
+
+struct JpegFrame {
+    int precision;
+    int height;
+    int width;
+    int components;
+};
+
+// the frame header of baseline and progressive JPEGs
+std::optional<JpegFrame> readJpegFrame(QByteArray const& data) {
+    auto const byte = [&data](int position) {
+        return int(quint8(data[position]));
+    };
+    if(data.size() < 4 || byte(0) != 0xff || byte(1) != 0xd8) {
+        return {};
+    }
+    int position = 2;
+    while(position + 4 <= data.size()) {
+        if(byte(position) != 0xff) {
+            return {};
+        }
+        auto const marker = byte(position + 1);
+        if(marker == 0xff) {
+            position++;
+            continue;
+        }
+        if(marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7)) {
+            position += 2;
+            continue;
+        }
+        auto const length = byte(position + 2) << 8 | byte(position + 3);
+        if(marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc) {
+            // only huffman coded baseline and progressive frames are supported by all viewers
+            if(marker > 0xc2 || position + 10 > data.size()) {
+                return {};
+            }
+            return JpegFrame{byte(position + 4), byte(position + 5) << 8 | byte(position + 6),
+                             byte(position + 7) << 8 | byte(position + 8), byte(position + 9)};
+        }
+        position += 2 + length;
+    }
+    return {};
+}
+
+// the cache keys of all PdfJpegFiles differ, so recordings of one are never replayed for another
+quint64 nextGeneration() {
+    static std::atomic<quint64> generation = 0;
+    return ++generation;
+}
+
+void embedJpegFiles(PdfDocument& document, PdfJpegFiles& jpegFiles) {
+    for(auto& [number, object] : document.objects) {
+        if(!object.stream) {
+            continue;
+        }
+        if(auto replacement = jpegFiles.replacement(object.value, *object.stream)) {
+            object.value = replacement->first;
+            object.stream = replacement->second;
+        }
+    }
+}
+
+int find(std::vector<int>& parents, int id) {
+    while(parents[id] != id) {
+        parents[id] = parents[parents[id]];
+        id = parents[id];
+    }
+    return id;
+}
+}
+
+std::optional<QByteArray> mergePdfs(std::vector<QByteArray> const& documents, QString const& title, PdfJpegFiles* jpegFiles) {
+    TraceSpan span("merge pdf", "pdf");
+    std::vector<PdfDocument> parsed;
+    for(auto const& data : documents) {
+        auto document = readDocument(data);
+        if(!document) {
+            return {};
+        }
+        if(jpegFiles) {
+            embedJpegFiles(*document, *jpegFiles);
+        }
+        parsed.push_back(std::move(*document));
+    }
+    // a placeholder which was not found would be shown instead of the photo
+    if(jpegFiles && !jpegFiles->replacedAll()) {
+        return {};
+    }
+
+    // numbers of the merged document: 1 catalog, 2 page tree, 3 info, the objects of the documents from 4 on
+    constexpr int catalog = 1, pageTree = 2, info = 3;
+    struct Entry {
+        int document;
+        int number;
+        bool page;
+    };
+    std::vector<Entry> entries;
+    std::vector<std::map<int, int>> ids(parsed.size());
+    for(int index = 0; index < int(parsed.size()); index++) {
+        auto const& document = parsed[index];
+        ids[index][document.pageTree] = pageTree;
+        auto const isPage = [&document](int number) {
+            return std::find(document.pages.begin(), document.pages.end(), number) != document.pages.end();
+        };
+        for(auto const& [number, object] : document.objects) {
+            if(number == document.catalog || number == document.pageTree || number == document.info) {
+                continue;
+            }
+            ids[index][number] = info + 1 + int(entries.size());
+            entries.push_back({index, number, isPage(number)});
+        }
+    }
+
+    // objects which are equal after their references are resolved are written once,
+    // merging objects can make the objects referencing them equal, too
+    std::vector<int> parents(info + 1 + entries.size());
+    std::iota(parents.begin(), parents.end(), 0);
+    auto const rewritten = [&](Entry const& entry) {
+        auto const& object = parsed[entry.document].objects.at(entry.number);
+        auto const& documentIds = ids[entry.document];
+        return renumber(object.value, [&](int number){
+            auto const id = documentIds.find(number);
+            return id == documentIds.end() ? 0 : find(parents, id->second);
+        });
+    };
+    for(bool merged = true; merged;) {
+        merged = false;
+        std::map<QByteArray, int> known;
+        for(auto const& entry : entries) {
+            if(entry.page) {
+                continue;
+            }
+            auto const id = find(parents, ids[entry.document][entry.number]);
+            auto const& object = parsed[entry.document].objects.at(entry.number);
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+            hash.addData(rewritten(entry));
+            hash.addData(object.stream ? "s" + *object.stream : QByteArray("v"));
+            auto const [existing, inserted] = known.emplace(hash.result(), id);
+            if(!inserted && find(parents, existing->second) != id) {
+                parents[id] = find(parents, existing->second);
+                merged = true;
+            }
+        }
+    }
+
+    // compact numbers of the written objects
+    std::vector<int> numbers(parents.size(), 0);
+    int nextNumber = info + 1;
+    for(auto const& entry : entries) {
+        auto const id = ids[entry.document][entry.number];
+        if(find(parents, id) == id) {
+            numbers[id] = nextNumber++;
+        }
+    }
+    numbers[pageTree] = pageTree;
+
+    QByteArray output = "%PDF-1.4\n%\xe2\xe3\xcf\xd3\n";
+    std::vector<qint64> offsets(nextNumber, 0);
+    auto const writeObject = [&output, &offsets](int number, QByteArray const& value, std::optional<QByteArray> const& stream) {
+        offsets[number] = output.size();
+        output += QByteArray::number(number) + " 0 obj\n" + value + "\n";
+        if(stream) {
+            output += "stream\n" + *stream + "\nendstream\n";
+        }
+        output += "endobj\n";
+    };
+
+    QByteArray kids;
+    int numberPages = 0;
+    for(int index = 0; index < int(parsed.size()); index++) {
+        for(auto const page : parsed[index].pages) {
+            kids += QByteArray::number(numbers[find(parents, ids[index][page])]) + " 0 R ";
+            numberPages++;
+        }
+    }
+    writeObject(catalog, "<<\n/Type /Catalog\n/Pages 2 0 R\n>>", {});
+    writeObject(pageTree, "<<\n/Type /Pages\n/Kids [ " + kids + "]\n/Count " + QByteArray::number(numberPages) + "\n>>", {});
+    writeObject(info, "<<\n/Title " + pdfString(title) + "\n/Producer " + pdfString("Potato Presenter") + "\n>>", {});
+    for(auto const& entry : entries) {
+        auto const id = ids[entry.document][entry.number];
+        if(find(parents, id) != id) {
+            continue;
+        }
+        auto const& documentIds = ids[entry.document];
+        auto const value = renumber(parsed[entry.document].objects.at(entry.number).value, [&](int number){
+            auto const target = documentIds.find(number);
+            return target == documentIds.end() ? 0 : numbers[find(parents, target->second)];
+        });
+        writeObject(numbers[id], value, parsed[entry.document].objects.at(entry.number).stream);
+    }
+
+    auto const xref = output.size();
+    output += "xref\n0 " + QByteArray::number(nextNumber) + "\n0000000000 65535 f \n";
+    for(int number = 1; number < nextNumber; number++) {
+        output += QByteArray::number(offsets[number]).rightJustified(10, '0') + " 00000 n \n";
+    }
+    output += "trailer\n<<\n/Size " + QByteArray::number(nextNumber) + "\n/Info 3 0 R\n/Root 1 0 R\n>>\nstartxref\n"
+            + QByteArray::number(xref) + "\n%%EOF\n";
+    return output;
+}
+
+PdfJpegFiles::PdfJpegFiles()
+    : mGeneration(nextGeneration())
+{
+}
+
+std::optional<QImage> PdfJpegFiles::placeholder(QString const& path) {
+    auto const modified = QFileInfo(path).lastModified();
+    auto file = std::find_if(mFiles.begin(), mFiles.end(), [&path](File const& file){return file.path == path;});
+    if(file == mFiles.end() || file->modified != modified) {
+        QFile jpeg(path);
+        // other images are not read completely
+        if(!jpeg.open(QIODevice::ReadOnly) || jpeg.peek(2) != "\xff\xd8") {
+            return {};
+        }
+        if(file == mFiles.end()) {
+            file = mFiles.insert(mFiles.end(), File{path, {}, {}, {}, {}});
+        }
+        file->modified = modified;
+        file->placeholder = {};
+        file->data = jpeg.readAll();
+        auto const frame = readJpegFrame(file->data);
+        if(!frame || frame->precision != 8 || (frame->components != 1 && frame->components != 3)) {
+            file->data.clear();
+            return {};
+        }
+        file->dictionary = "<<\n/Type /XObject\n/Subtype /Image\n/Width " + QByteArray::number(frame->width)
+                + "\n/Height " + QByteArray::number(frame->height)
+                + (frame->components == 1 ? "\n/ColorSpace /DeviceGray" : "\n/ColorSpace /DeviceRGB")
+                + "\n/BitsPerComponent 8\n/Filter /DCTDecode\n/Length " + QByteArray::number(file->data.size()) + "\n>>";
+        file->placeholder = createPlaceholder(quint32(file - mFiles.begin()));
+    }
+    if(file->placeholder.isNull()) {
+        return {};
+    }
+    mHandedOut.insert(quint32(file - mFiles.begin()));
+    return file->placeholder;
+}
+
+QByteArray PdfJpegFiles::cacheKey() const {
+    return "jpeg " + QByteArray::number(mGeneration);
+}
+
+std::optional<std::pair<QByteArray, QByteArray>> PdfJpegFiles::replacement(QByteArray const& dictionary, QByteArray const& stream) {
+    auto const index = placeholderIndex(dictionary, stream);
+    if(!index || *index >= mFiles.size() || mFiles[*index].placeholder.isNull()) {
+        return {};
+    }
+    mReplaced.insert(*index);
+    return std::pair(mFiles[*index].dictionary, mFiles[*index].data);
+}
+
+void PdfJpegFiles::beginExport() {
+    mHandedOut.clear();
+    mReplaced.clear();
+    mGeneration = nextGeneration();
+}
+
+bool PdfJpegFiles::replacedAll() const {
+    return std::includes(mReplaced.begin(), mReplaced.end(), mHandedOut.begin(), mHandedOut.end());
+}
+
+std::size_t PdfJpegFiles::replacedFiles() const {
+    return mReplaced.size();
+}
+
+void PdfJpegFiles::releaseUnused() {
+    for(quint32 index = 0; index < mFiles.size(); index++) {
+        if(mReplaced.count(index) == 0) {
+            // the file is read again when it is used the next time
+            mFiles[index].modified = {};
+            mFiles[index].data.clear();
+            mFiles[index].placeholder = {};
+        }
+    }
+}
+
+void PdfJpegFiles::clear() {
+    mFiles.clear();
+    mHandedOut.clear();
+    mReplaced.clear();
+    mGeneration = nextGeneration();
+}
+
+QImage PdfJpegFiles::createPlaceholder(quint32 index) {
+    QImage placeholder(placeholderWidth, 1, QImage::Format_Mono);
+    // QPdfWriter writes black and white images unchanged as image masks
+    placeholder.setColorTable({QColor(Qt::black).rgba(), QColor(Qt::white).rgba()});
+    qToBigEndian(placeholderMagic, placeholder.scanLine(0));
+    qToBigEndian(index, placeholder.scanLine(0) + 4);
+    return placeholder;
+}
+
+std::optional<quint32> PdfJpegFiles::placeholderIndex(QByteArray const& dictionary, QByteArray const& stream) {
+    if(!containsName(dictionary, "/Image") || valueOf(dictionary, "/Width") != placeholderWidth || valueOf(dictionary, "/Height") != 1) {
+        return {};
+    }
+    auto bits = stream;
+    if(containsName(dictionary, "/FlateDecode")) {
+        // qUncompress expects the size of the data in front of the zlib stream
+        QByteArray size(4, 0);
+        qToBigEndian(quint32(placeholderWidth / 8), size.data());
+        bits = qUncompress(size + stream);
+    }
+    if(bits.size() != placeholderWidth / 8 || qFromBigEndian<quint32>(bits.constData()) != placeholderMagic) {
+        return {};
+    }
+    return qFromBigEndian<quint32>(bits.constData() + 4);
+}
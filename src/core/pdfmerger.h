@@ -0,0 +1,73 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef PDFMERGER_H
+#define PDFMERGER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QImage>
+#include <QString>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include "imagefileembedder.h"
+
+class PdfJpegFiles;
+
+// Combines pdf documents written by QPdfWriter into one document with the pages in the given order.
+// Objects which are equal in several documents, e.g. an image used on slides of different documents,
+// are written once. Only documents with a classic cross-reference table and without object streams
+// are supported, returns nullopt if a document cannot be read.
+// Placeholders of jpegFiles are replaced by their JPEG files, returns nullopt if a placeholder
+// handed out for the export was not found.
+std::optional<QByteArray> mergePdfs(std::vector<QByteArray> const& documents, QString const& title, PdfJpegFiles* jpegFiles = nullptr);
+
+// JPEG files which are embedded into merged documents without decoding and encoding them again.
+// Boxes draw a small placeholder image instead of the file and mergePdfs replaces the image of the placeholder
+// by the data of the file. Like the other caches of images it is not thread-safe.
+class PdfJpegFiles : public ImageFileEmbedder
+{
+public:
+    PdfJpegFiles();
+    // nullopt if the file cannot be embedded unchanged, e.g. CMYK or 12 bit JPEGs
+    std::optional<QImage> placeholder(QString const& path) override;
+    QByteArray cacheKey() const override;
+    // dictionary and stream of the image object replacing the placeholder with the given data
+    std::optional<std::pair<QByteArray, QByteArray>> replacement(QByteArray const& dictionary, QByteArray const& stream);
+
+    // forgets which placeholders were handed out and replaced, recordings of earlier exports are not replayed
+    void beginExport();
+    // true if every placeholder handed out since beginExport was replaced
+    bool replacedAll() const;
+    // number of files embedded since beginExport
+    std::size_t replacedFiles() const;
+    // releases the data of the files which were not embedded since beginExport
+    void releaseUnused();
+    void clear();
+
+    // placeholder of the file with the index, e.g. to check that QPdfWriter writes it as expected
+    static QImage createPlaceholder(quint32 index);
+    // index of the file the placeholder stands for, if the pdf object is a placeholder
+    static std::optional<quint32> placeholderIndex(QByteArray const& dictionary, QByteArray const& stream);
+
+private:
+    struct File {
+        QString path;
+        QDateTime modified;
+        QByteArray data;
+        QByteArray dictionary;
+        QImage placeholder;
+    };
+    std::vector<File> mFiles;
+    std::set<quint32> mHandedOut;
+    std::set<quint32> mReplaced;
+    // changes when recordings with the placeholders must not be replayed anymore
+    quint64 mGeneration;
+};
+
+#endif // PDFMERGER_H
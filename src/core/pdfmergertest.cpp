@@ -0,0 +1,221 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "pdfmergertest.h"
+#include "pdfmerger.h"
+
+#include <QBuffer>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QRegularExpression>
+#include <algorithm>
+
+QTEST_MAIN(PdfMergerTest)
+
+namespace {
+// the pages have different widths to find them in the merged document, the first page of
+// the document is 100mm + 10mm * firstPage wide
+QByteArray writeDocument(int firstPage, int numberPages, QImage const& image) {
+    QByteArray output;
+    QBuffer buffer(&output);
+    buffer.open(QIODevice::WriteOnly);
+    QPdfWriter pdfWriter(&buffer);
+    pdfWriter.setPageMargins(QMargins(0, 0, 0, 0));
+    pdfWriter.setPageSize(QPageSize(QSizeF(100 + 10 * firstPage, 100), QPageSize::Millimeter));
+    QPainter painter(&pdfWriter);
+    for(int page = 0; page < numberPages; page++) {
+        if(page > 0) {
+            pdfWriter.setPageSize(QPageSize(QSizeF(100 + 10 * (firstPage + page), 100), QPageSize::Millimeter));
+            pdfWriter.newPage();
+        }
+        painter.drawText(QPoint(100, 100), QString("Page %1").arg(firstPage + page));
+        painter.drawImage(QRect(100, 200, 400, 400), image);
+    }
+    painter.end();
+    return output;
+}
+
+QImage createImage() {
+    QImage image(32, 32, QImage::Format_RGB32);
+    for(int y = 0; y < image.height(); y++) {
+        for(int x = 0; x < image.width(); x++) {
+            image.setPixel(x, y, qRgb(x * 8, y * 8, (x * y) % 256));
+        }
+    }
+    return image;
+}
+
+// objects by their number, found through the cross-reference table like a viewer does,
+// empty if an entry does not point to its object
+std::map<int, QByteArray> readObjects(QByteArray const& data) {
+    auto const startxref = data.lastIndexOf("startxref");
+    auto const xref = data.mid(startxref + 9).trimmed().split('\n').front().toInt();
+    auto const lines = data.mid(xref).split('\n');
+    if(lines.size() < 2 || lines[0] != "xref") {
+        return {};
+    }
+    auto const size = lines[1].split(' ').value(1).toInt();
+    std::map<int, QByteArray> objects;
+    for(int number = 1; number < size; number++) {
+        auto const offset = lines.value(number + 2).split(' ').front().toInt();
+        auto const header = QByteArray::number(number) + " 0 obj";
+        if(data.mid(offset, header.size()) != header) {
+            return {};
+        }
+        objects[number] = data.mid(offset, data.indexOf("endobj", offset) - offset);
+    }
+    return objects;
+}
+
+std::vector<int> references(QByteArray const& value) {
+    static QRegularExpression const reference("(\\d+)\\s+\\d+\\s+R\\b");
+    std::vector<int> numbers;
+    auto matches = reference.globalMatch(QString::fromLatin1(value));
+    while(matches.hasNext()) {
+        numbers.push_back(matches.next().captured(1).toInt());
+    }
+    return numbers;
+}
+
+// widths of the media boxes of the pages in the order of the page tree
+std::vector<double> pageWidths(QByteArray const& data) {
+    auto const objects = readObjects(data);
+    auto const pageTree = references(objects.at(references(objects.at(1).mid(objects.at(1).indexOf("/Pages"))).front()));
+    std::vector<double> widths;
+    static QRegularExpression const mediaBox("/MediaBox\\s*\\[\\s*\\S+\\s+\\S+\\s+(\\S+)");
+    for(auto const page : pageTree) {
+        widths.push_back(mediaBox.match(QString::fromLatin1(objects.at(page))).captured(1).toDouble());
+    }
+    return widths;
+}
+
+// data of the streams, cut to their /Length like a viewer does, /Length1 of fonts is not the length
+std::vector<QByteArray> streams(std::map<int, QByteArray> const& objects) {
+    static QRegularExpression const streamKeyword(">>\\s*stream");
+    static QRegularExpression const lengthKey("/Length\\s+(\\d+)(\\s+\\d+\\s+R)?");
+    std::vector<QByteArray> result;
+    for(auto const& [number, object] : objects) {
+        auto const keyword = streamKeyword.match(QString::fromLatin1(object));
+        if(!keyword.hasMatch()) {
+            continue;
+        }
+        auto const length = lengthKey.match(QString::fromLatin1(object.left(keyword.capturedStart())));
+        if(!length.hasMatch()) {
+            return {};
+        }
+        auto size = length.captured(1).toInt();
+        if(!length.captured(2).isEmpty()) {
+            auto const lengthObject = objects.find(size);
+            if(lengthObject == objects.end()) {
+                return {};
+            }
+            size = lengthObject->second.mid(lengthObject->second.indexOf("obj") + 3).trimmed().toInt();
+        }
+        auto dataStart = keyword.capturedEnd();
+        if(object.mid(dataStart, 2) == "\r\n") {
+            dataStart += 2;
+        }
+        else if(object.mid(dataStart, 1) == "\n") {
+            dataStart++;
+        }
+        // only the end of line may follow the data
+        if(object.mid(dataStart + size).trimmed() != "endstream") {
+            return {};
+        }
+        result.push_back(object.mid(dataStart, size));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+int countImages(std::map<int, QByteArray> const& objects) {
+    return int(std::count_if(objects.begin(), objects.end(), [](auto const& object){
+        return object.second.contains("/Subtype /Image");
+    }));
+}
+}
+
+void PdfMergerTest::testPageOrder() {
+    auto const image = createImage();
+    auto const merged = mergePdfs({writeDocument(0, 2, image), writeDocument(2, 1, image), writeDocument(3, 2, image)}, "Title");
+    QVERIFY(merged.has_value());
+    QVERIFY(!readObjects(*merged).empty());
+    QVERIFY(merged->contains("/Count 5"));
+    auto const widths = pageWidths(*merged);
+    QCOMPARE(widths.size(), std::size_t(5));
+    QVERIFY(std::is_sorted(widths.begin(), widths.end()));
+    QVERIFY(std::adjacent_find(widths.begin(), widths.end()) == widths.end());
+}
+
+void PdfMergerTest::testSharedObjects() {
+    auto const image = createImage();
+    std::vector<QByteArray> documents{writeDocument(0, 1, image), writeDocument(1, 1, image), writeDocument(2, 1, image)};
+    for(auto const& document : documents) {
+        QCOMPARE(countImages(readObjects(document)), 1);
+    }
+    auto const merged = mergePdfs(documents, "Title");
+    QVERIFY(merged.has_value());
+    auto const objects = readObjects(*merged);
+    // the image is written once for all documents
+    QCOMPARE(countImages(objects), 1);
+    // every reference points to a written object
+    for(auto const& [number, object] : objects) {
+        auto const value = object.left(object.indexOf("stream")).mid(object.indexOf("obj"));
+        for(auto const reference : references(value)) {
+            QVERIFY2(objects.count(reference) == 1, qPrintable(QString("object %1 references %2").arg(number).arg(reference)));
+        }
+    }
+}
+
+void PdfMergerTest::testStreams() {
+    auto const image = createImage();
+    std::vector<QByteArray> documents{writeDocument(0, 2, image), writeDocument(2, 1, image)};
+    std::vector<QByteArray> sourceStreams;
+    for(auto const& document : documents) {
+        auto const documentStreams = streams(readObjects(document));
+        QVERIFY(!documentStreams.empty());
+        sourceStreams.insert(sourceStreams.end(), documentStreams.begin(), documentStreams.end());
+    }
+    std::sort(sourceStreams.begin(), sourceStreams.end());
+    sourceStreams.erase(std::unique(sourceStreams.begin(), sourceStreams.end()), sourceStreams.end());
+
+    auto const merged = mergePdfs(documents, "Title");
+    QVERIFY(merged.has_value());
+    // every stream is copied unchanged, equal streams once, e.g. the embedded fonts with a /Length1 before their /Length
+    QCOMPARE(streams(readObjects(*merged)), sourceStreams);
+}
+
+void PdfMergerTest::testMergeMerged() {
+    auto const image = createImage();
+    auto const merged = mergePdfs({writeDocument(0, 2, image), writeDocument(2, 1, image)}, "Title");
+    QVERIFY(merged.has_value());
+    auto const twice = mergePdfs({*merged, *merged}, "Twice");
+    QVERIFY(twice.has_value());
+    QCOMPARE(pageWidths(*twice).size(), std::size_t(6));
+    QCOMPARE(countImages(readObjects(*twice)), 1);
+}
+
+void PdfMergerTest::testRejectUnsupported() {
+    QFETCH(QByteArray, document);
+    auto const image = createImage();
+    QVERIFY(!mergePdfs({writeDocument(0, 1, image), document}, "Title").has_value());
+}
+
+void PdfMergerTest::testRejectUnsupported_data() {
+    QTest::addColumn<QByteArray>("document");
+    auto const document = writeDocument(1, 1, createImage());
+    QTest::newRow("cross-reference stream") << QByteArray("%PDF-1.5\n1 0 obj\n<< /Type /XRef /Size 2 /W [1 2 1] /Length 0 >>\n"
+                                                          "stream\n\nendstream\nendobj\nstartxref\n9\n%%EOF\n");
+    auto hybrid = document;
+    hybrid.insert(hybrid.lastIndexOf("trailer") + 10, "/XRefStm 0\n");
+    QTest::newRow("hybrid") << hybrid;
+    // same length, the offsets of the objects stay valid
+    auto objectStream = document;
+    objectStream.replace("/Type /Catalog", "/Type /ObjStm ");
+    QTest::newRow("object stream") << objectStream;
+    QTest::newRow("truncated") << document.left(document.size() / 2);
+}
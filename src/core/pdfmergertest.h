@@ -0,0 +1,24 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef PDFMERGERTEST_H
+#define PDFMERGERTEST_H
+
+#include <QtTest/QTest>
+
+class PdfMergerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testPageOrder();
+    void testSharedObjects();
+    void testStreams();
+    void testMergeMerged();
+    void testRejectUnsupported();
+    void testRejectUnsupported_data();
+};
+
+#endif // PDFMERGERTEST_H
@@ -0,0 +1,203 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "potatobench.h"
+#include "parser.h"
+#include "presentation.h"
+#include "sliderenderer.h"
+#include "pdfcreator.h"
+#include "latexcachemanager.h"
+#include "imageresampler.h"
+
+#include <QImage>
+#include <QPainter>
+
+QTEST_MAIN(PotatoBench)
+
+namespace {
+
+// a presentation with numberSlides slides and boxesPerSlide boxes per slide,
+// the boxes cycle through markdown, code, images and formulas
+std::string syntheticDeck(int numberSlides, int boxesPerSlide) {
+    QString deck;
+    for(int slide = 0; slide < numberSlides; slide++) {
+        deck += QString("\\slide slide%1\n\\title Slide %1\n").arg(slide);
+        for(int box = 0; box < boxesPerSlide; box++) {
+            switch(box % 5) {
+            case 0:
+                deck += "\\body\n* An *item* with __emphasis__\n    * and a **subitem**\n* Force $F = ma$\n";
+                break;
+            case 1:
+                deck += "\\code[language: C++]\nint main() {\n    return 0;\n}\n";
+                break;
+            case 2:
+                deck += "\\image image.png\n";
+                break;
+            case 3:
+                deck += "\\latex \\{$\\sum_{i=0}^n i = \\frac{n(n+1)}{2}$\\}\n";
+                break;
+            default:
+                deck += QString("\\text[color: #444; font-size: 30] Text %1 on slide %2\n").arg(box).arg(slide);
+                break;
+            }
+        }
+    }
+    return deck.toStdString();
+}
+
+void addSizes() {
+    QTest::addColumn<int>("numberSlides");
+    QTest::addColumn<int>("boxesPerSlide");
+    QTest::newRow("10x5") << 10 << 5;
+    QTest::newRow("100x10") << 100 << 10;
+    QTest::newRow("500x10") << 500 << 10;
+}
+
+// configuration entries for every second box
+ConfigBoxes syntheticConfig(SlideList const& slides) {
+    ConfigBoxes config;
+    int number = 0;
+    for(auto const& slide : slides.vector) {
+        for(auto const& box : slide->boxes()) {
+            if(number++ % 2 == 0) {
+                config.addRect({5, QRect(100, 100, 600, 300)}, box->configId());
+            }
+        }
+    }
+    return config;
+}
+
+Presentation::Ptr buildPresentation(int numberSlides, int boxesPerSlide, QString const& directory) {
+    auto const parserOutput = generateSlides(syntheticDeck(numberSlides, boxesPerSlide), directory);
+    if(!parserOutput.successfull()) {
+        return {};
+    }
+    auto presentation = std::make_shared<Presentation>();
+    presentation->setConfig(syntheticConfig(parserOutput.slideList()));
+    presentation->setData({parserOutput.slideList()});
+    return presentation;
+}
+
+QImage slideImage(Presentation::Ptr const& presentation) {
+    QImage image(presentation->dimensions(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    return image;
+}
+}
+
+void PotatoBench::initTestCase() {
+    QVERIFY(mDirectory.isValid());
+    QImage image(800, 600, QImage::Format_RGB32);
+    image.fill(Qt::darkCyan);
+    QVERIFY(image.save(mDirectory.filePath("image.png")));
+    // the formulas are not measured, a TeX installation is not needed
+    cacheManager().setStubConversion(true);
+}
+
+void PotatoBench::benchGenerateSlides() {
+    QFETCH(int, numberSlides);
+    QFETCH(int, boxesPerSlide);
+    auto const deck = syntheticDeck(numberSlides, boxesPerSlide);
+    QBENCHMARK {
+        auto const parserOutput = generateSlides(deck, mDirectory.path());
+        QVERIFY(parserOutput.successfull());
+    }
+}
+
+void PotatoBench::benchGenerateSlides_data() {
+    addSizes();
+}
+
+void PotatoBench::benchApplyConfiguration() {
+    QFETCH(int, numberSlides);
+    QFETCH(int, boxesPerSlide);
+    auto const parserOutput = generateSlides(syntheticDeck(numberSlides, boxesPerSlide), mDirectory.path());
+    QVERIFY(parserOutput.successfull());
+    auto const config = syntheticConfig(parserOutput.slideList());
+    PresentationData data(parserOutput.slideList());
+    QBENCHMARK {
+        data.applyConfiguration(config);
+        data.slideListDefaultApplied();
+    }
+}
+
+void PotatoBench::benchApplyConfiguration_data() {
+    addSizes();
+}
+
+void PotatoBench::benchMarkdownDrawContent() {
+    auto const presentation = buildPresentation(1, 1, mDirectory.path());
+    QVERIFY(presentation);
+    auto const slide = presentation->data().slideListDefaultApplied().slideAt(0);
+    auto const box = slide->boxes().back();
+    auto image = slideImage(presentation);
+    QPainter painter(&image);
+    QBENCHMARK {
+        box->drawContent(painter, slide->context());
+    }
+}
+
+void PotatoBench::benchRenderSlides() {
+    QFETCH(int, numberSlides);
+    QFETCH(int, boxesPerSlide);
+    auto const presentation = buildPresentation(numberSlides, boxesPerSlide, mDirectory.path());
+    QVERIFY(presentation);
+    auto image = slideImage(presentation);
+    QPainter painter(&image);
+    SlideRenderer renderer(painter);
+    auto const& slides = presentation->data().slideListDefaultApplied();
+    QBENCHMARK {
+        for(auto const& slide : slides.vector) {
+            renderer.paintSlide(slide);
+        }
+    }
+}
+
+void PotatoBench::benchRenderSlides_data() {
+    addSizes();
+}
+
+void PotatoBench::benchCreatePdf() {
+    auto const presentation = buildPresentation(50, 5, mDirectory.path());
+    QVERIFY(presentation);
+    QBENCHMARK {
+        PDFCreator().createPdf(mDirectory.filePath("bench.pdf"), presentation);
+    }
+}
+
+void PotatoBench::benchDownscale() {
+    QFETCH(int, kernel);
+    // odd sizes exercise the scalar tails of the vector kernels
+    QImage image(4001, 3001, QImage::Format_ARGB32_Premultiplied);
+    for(int y = 0; y < image.height(); y++) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for(int x = 0; x < image.width(); x++) {
+            line[x] = qPremultiply(qRgba(x % 256, y % 256, (x + y) % 256, (x * y) % 256));
+        }
+    }
+    auto const size = QSize(700, 500);
+    if(kernel < 0) {
+        QBENCHMARK {
+            image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        return;
+    }
+    auto const resampleKernel = static_cast<ResampleKernel>(kernel);
+    if(!resampleKernelSupported(resampleKernel)) {
+        QSKIP("The kernel is not supported by this CPU.");
+    }
+    QBENCHMARK {
+        downscaleImage(image, size, resampleKernel);
+    }
+}
+
+void PotatoBench::benchDownscale_data() {
+    QTest::addColumn<int>("kernel");
+    QTest::newRow("qt") << -1;
+    for(auto const kernel : {ResampleKernel::Scalar, ResampleKernel::Sse2, ResampleKernel::Avx2, ResampleKernel::Neon}) {
+        QTest::newRow(resampleKernelName(kernel).toUtf8().constData()) << static_cast<int>(kernel);
+    }
+}
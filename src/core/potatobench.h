@@ -0,0 +1,36 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef POTATOBENCH_H
+#define POTATOBENCH_H
+
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+
+// Benchmarks of the build pipeline on synthetic presentations.
+// Run with "-o results.xml,xml" to get machine readable results.
+class PotatoBench : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchGenerateSlides();
+    void benchGenerateSlides_data();
+    void benchApplyConfiguration();
+    void benchApplyConfiguration_data();
+    void benchMarkdownDrawContent();
+    void benchRenderSlides();
+    void benchRenderSlides_data();
+    void benchCreatePdf();
+    void benchDownscale();
+    void benchDownscale_data();
+
+private:
+    QTemporaryDir mDirectory;
+};
+
+#endif // POTATOBENCH_H
@@ -0,0 +1,52 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "deckgenerator.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <iostream>
+
+// Writes a synthetic presentation, e.g. potatodeckgen --slides 5000 --template /tmp/large
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("potatodeckgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates a synthetic presentation <output>.potato and its configuration <output>.json.");
+    parser.addHelpOption();
+    QCommandLineOption slidesOption("slides", "Number of slides.", "count", "100");
+    QCommandLineOption boxesOption("boxes", "Number of boxes per slide.", "count", "5");
+    QCommandLineOption templateOption("template", "Use a generated template.");
+    QCommandLineOption pauseOption("pause-density", "Probability that a text box is followed by a \\pause.", "probability", "0");
+    QCommandLineOption sectionOption("section-every", "Start a new section every <count> slides, 0 for no sections.", "count", "0");
+    QCommandLineOption variablesOption("variables", "Number of variables used in the texts.", "count", "0");
+    QCommandLineOption seedOption("seed", "Seed of the random generator.", "seed", "1");
+    parser.addOptions({slidesOption, boxesOption, templateOption, pauseOption, sectionOption, variablesOption, seedOption});
+    parser.addPositionalArgument("output", "Path of the presentation without suffix.");
+    parser.process(a);
+
+    auto const arguments = parser.positionalArguments();
+    if(arguments.size() != 1) {
+        parser.showHelp(1);
+    }
+
+    DeckOptions options;
+    options.slides = parser.value(slidesOption).toInt();
+    options.boxesPerSlide = parser.value(boxesOption).toInt();
+    options.useTemplate = parser.isSet(templateOption);
+    options.pauseDensity = parser.value(pauseOption).toDouble();
+    options.slidesPerSection = parser.value(sectionOption).toInt();
+    options.variables = parser.value(variablesOption).toInt();
+    options.seed = parser.value(seedOption).toUInt();
+
+    if(!writeDeck(generateDeck(options), arguments[0])) {
+        std::cerr << "Cannot write " << arguments[0].toStdString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
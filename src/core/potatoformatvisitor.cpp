@@ -334,8 +334,10 @@ void PotatoFormatVisitor::applyPause(QString text) {
     auto box = std::static_pointer_cast<TextBox>(lastTextBox->clone());
     if(!text.isEmpty() && !box->text().isEmpty())
         text.insert(0, '\n');
-    box->setProperty("text", {lastTextBox->text() + text, box->line()});
-    box->style().mText = lastTextBox->text() + text;
+    // the property and the style share one string
+    auto const pausedText = lastTextBox->text() + text;
+    box->setProperty("text", {pausedText, box->line()});
+    box->style().mText = pausedText;
     box->setPauseCounter(mPauseCount);
     lastTextBox->setId(lastTextBox->configId() + "-" + mPauseCount);
     lastTextBox->setConfigId(box->id());
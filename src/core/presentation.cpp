@@ -21,14 +21,6 @@ void forEachBox(auto const& slides, auto func) {
             func(slide, box);
 }
 
-Box::Ptr findBoxCondition(std::vector<Slide::Ptr> slides, auto func) {
-    for (auto const& slide: slides)
-        for (auto const& box: slide->boxes())
-            if(func(slide, box))
-                return box;
-    return {};
-}
-
 }
 
 Presentation::Presentation() : QObject()
@@ -38,6 +30,8 @@ Presentation::Presentation() : QObject()
 void Presentation::setData(PresentationData data) {
     mData = data;
     mData.applyConfiguration(mConfig);
+    // resolve the defaults while building, so painting does not need to
+    mData.slideListDefaultApplied();
 }
 
 const SlideList &Presentation::slideList() const {
@@ -45,22 +39,23 @@ const SlideList &Presentation::slideList() const {
 }
 
 void Presentation::setBoxGeometry(const QString &boxId, BoxGeometry const& rect, int pageNumber) {
-    auto const& box = mData.slides().findBox(boxId);
+    auto const& box = findBox(boxId);
     if(!box) {
         return;
     }
     box->setGeometry(rect);
     mConfig.addRect(rect.toValue(), boxId);
-    Q_EMIT slideChanged(pageNumber, pageNumber);
+    resolveBox(boxId, pageNumber);
     Q_EMIT boxGeometryChanged();
+    Q_EMIT configurationChanged(boxId);
 }
 
 void Presentation::deleteBoxGeometry(const QString &boxId, int pageNumber) {
     mConfig.deleteRect(boxId);
     findBox(boxId)->setGeometry(BoxGeometry());
-    mData.applyConfiguration(mConfig);
-    Q_EMIT slideChanged(pageNumber, pageNumber);
+    resolveBox(boxId, pageNumber);
     Q_EMIT boxGeometryChanged();
+    Q_EMIT configurationChanged(boxId);
 }
 
 void Presentation::deleteBoxAngle(const QString &boxId, int pageNumber) {
@@ -68,9 +63,43 @@ void Presentation::deleteBoxAngle(const QString &boxId, int pageNumber) {
     auto const box = findBox(boxId);
     auto const rect = box->geometry().rect();
     findBox(boxId)->setGeometry(BoxGeometry(rect, 0));
-    mData.applyConfiguration(mConfig);
-    Q_EMIT slideChanged(pageNumber, pageNumber);
+    resolveBox(boxId, pageNumber);
+    Q_EMIT boxGeometryChanged();
+    Q_EMIT configurationChanged(boxId);
+}
+
+BoxGeometryState Presentation::boxGeometryState(QString const& boxId) const {
+    auto const box = findBox(boxId);
+    if(!box) {
+        return {mConfig.findRect(boxId), BoxGeometry()};
+    }
+    return {mConfig.findRect(boxId), box->geometry()};
+}
+
+void Presentation::setBoxGeometryState(QString const& boxId, BoxGeometryState const& state, int pageNumber) {
+    if(state.mConfig) {
+        mConfig.addRect(state.mConfig.value(), boxId);
+    }
+    else {
+        mConfig.deleteRect(boxId);
+    }
+    // the configuration is restored even if the box is gone, e.g. after its slide was removed
+    if(auto const box = findBox(boxId)) {
+        box->setGeometry(state.mGeometry);
+    }
+    resolveBox(boxId, pageNumber);
     Q_EMIT boxGeometryChanged();
+    Q_EMIT configurationChanged(boxId);
+}
+
+void Presentation::resolveBox(QString const& boxId, int pageNumber) {
+    // boxes of a class defined by this box are on other slides as well
+    if(mData.updateBox(boxId, mConfig)) {
+        Q_EMIT slideChanged(0, mData.slides().numberSlides());
+    }
+    else {
+        Q_EMIT slideChanged(pageNumber, pageNumber);
+    }
 }
 
 const ConfigBoxes &Presentation::configuration() const {
@@ -80,6 +109,7 @@ const ConfigBoxes &Presentation::configuration() const {
 void Presentation::setConfig(ConfigBoxes config) {
     mConfig = config;
     Q_EMIT rebuildNeeded();
+    Q_EMIT configurationChanged(QString());
 }
 
 
@@ -94,23 +124,7 @@ int Presentation::numberOfSlides() const {
 }
 
 Box::Ptr Presentation::findBox(const QString &id) const {
-    if(id.startsWith("intern")) {
-        auto const box = findBoxCondition(mData.slides().vector, [id](auto const& slide, auto const& box) {
-            return id.contains(slide->id()) && box->id() == id;
-        });
-        if (box)
-            return box;
-    }
-
-    else{
-        auto const box = findBoxCondition(mData.slides().vector, [id](auto const& slide, auto const& box) {
-            return box->id() == id;
-        });
-        if (box)
-            return box;
-    }
-
-    return {};
+    return mData.styleCascade().findBox(id);
 }
 
 std::pair<Slide::Ptr, Box::Ptr> Presentation::findBoxForLine(int line) const {
@@ -146,6 +160,7 @@ void Presentation::deleteNotNeededConfigurations() {
     });
     mConfig.deleteAllRectsExcept(ids);
     Q_EMIT slideChanged(0, mData.slides().numberSlides());
+    Q_EMIT configurationChanged(QString());
 }
 
 
@@ -16,6 +16,12 @@
 
 class Template;
 
+// geometry of a box together with its entry in the configuration
+// (no entry means the box is placed by class and template)
+struct BoxGeometryState {
+    std::optional<MemberBoxGeometry> mConfig;
+    BoxGeometry mGeometry;
+};
 
 class Presentation : public QObject
 {
@@ -49,6 +55,10 @@ public:
     void setBoxGeometry(QString const& boxId, const BoxGeometry &rect, int pageNumber);
     void deleteBoxGeometry(QString const& boxId, int pageNumber);
     void deleteBoxAngle(QString const& boxId, int pageNumber);
+    // read and restore the geometry of a single box, e.g. for undo / redo,
+    // without rebuilding the presentation
+    BoxGeometryState boxGeometryState(QString const& boxId) const;
+    void setBoxGeometryState(QString const& boxId, BoxGeometryState const& state, int pageNumber);
 
     // Configuration Class to follow and save the Geometry of the boxes
     void setConfig(ConfigBoxes config);
@@ -63,6 +73,13 @@ Q_SIGNALS:
     void slideChanged(int pageNumberFront, int pageNumberBack);
     void rebuildNeeded();
     void boxGeometryChanged();
+    // emitted if the configuration entry of a box changed,
+    // an empty id means that the whole configuration changed
+    void configurationChanged(QString const& boxId);
+
+private:
+    // resolves the box after its configuration changed and emits the changed slides
+    void resolveBox(QString const& boxId, int pageNumber);
 
 private:
     PresentationData mData;
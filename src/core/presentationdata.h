@@ -3,6 +3,7 @@
 
 #include "slide.h"
 #include "configboxes.h"
+#include "stylecascade.h"
 
 class Template;
 
@@ -73,32 +74,25 @@ public:
     // starts the process that applys defined classes, templates,
     // the geometries given by config, and the properties to the boxes
     void applyConfiguration(ConfigBoxes const& config);
+    // resolves the style of a single box and the boxes that depend on it,
+    // returns true if other boxes were resolved, too
+    bool updateBox(QString const& boxId, ConfigBoxes const& config);
 
     SlideList const& slides() const;
+    StyleCascade const& styleCascade() const;
     int numberSlides() const;
 
     // use this to render slide
     // slides with the default properties set
     // e.g. by \setvar color black
+    // the defaults are applied once after each applyConfiguration
     SlideList const& slideListDefaultApplied();
 
-    // find the classes that are defined in the PresentationData and apply it to another SlideList
-    // (config that belongs to PresentationData is needed)
-    void applyDefinedClass(SlideList const& slides, ConfigBoxes const& config);
-
-private:
-    // creating and applying of a map of the boxes that defines
-    // a class e.g. has the argument defineclass
-    std::map<QString, BoxStyle> createMapDefinesClass(const ConfigBoxes &config) const;
-
-    void setTitleIfTextUnset(SlideList const& slides);
-    void applyJSONGeometries(ConfigBoxes const& config);
-    void applyJSONToBox(Slide::Ptr slide, Box::Ptr box, ConfigBoxes const& config) const;
-
-
 private:
     SlideList mSlides;
     std::shared_ptr<Template> mTemplate;
+    StyleCascade mCascade;
+    bool mDefaultsApplied = false;
 };
 
 #endif // PRESENTATIONDATA_H
@@ -0,0 +1,183 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "scalingtest.h"
+#include "deckgenerator.h"
+#include "parser.h"
+#include "presentation.h"
+#include "template.h"
+#include "sliderenderer.h"
+#include "latexcachemanager.h"
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLoggingCategory>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+QTEST_MAIN(ScalingTest)
+
+namespace {
+auto const sizes = std::vector<int>{250, 500, 1000, 2000};
+constexpr int boxesPerSlide = 6;
+constexpr int repetitions = 5;
+// stages faster than this at the largest size are dominated by noise and not checked
+constexpr double minimalMilliseconds = 20;
+// allowed difference between the measured and the expected exponent of the growth,
+// quadratic growth of a linear stage still exceeds it
+constexpr double tolerance = 0.5;
+
+// current resident memory, unlike the peak of getrusage it also shrinks
+long currentRssKiB() {
+#ifdef Q_OS_UNIX
+    QFile statm("/proc/self/statm");
+    if(statm.open(QIODevice::ReadOnly)) {
+        auto const fields = statm.readAll().split(' ');
+        if(fields.size() > 1) {
+            return fields[1].toLong() * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+    }
+#endif
+    return 0;
+}
+
+// slope of log(time) over log(slides), e.g. 1 for linear and 2 for quadratic growth
+double growthExponent(std::vector<ScalingTest::Measurement> const& measurements) {
+    double meanX = 0, meanY = 0;
+    for(auto const& measurement : measurements) {
+        meanX += std::log(measurement.slides);
+        meanY += std::log(std::max(measurement.milliseconds, 1e-3));
+    }
+    meanX /= measurements.size();
+    meanY /= measurements.size();
+    double covariance = 0, variance = 0;
+    for(auto const& measurement : measurements) {
+        auto const x = std::log(measurement.slides) - meanX;
+        covariance += x * (std::log(std::max(measurement.milliseconds, 1e-3)) - meanY);
+        variance += x * x;
+    }
+    return covariance / variance;
+}
+}
+
+void ScalingTest::initTestCase() {
+    // the parser logs every command
+    QLoggingCategory::setFilterRules("default.info=false");
+    cacheManager().setStubConversion(true);
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    for(auto const slides : sizes) {
+        DeckOptions options;
+        options.slides = slides;
+        options.boxesPerSlide = boxesPerSlide;
+        options.useTemplate = true;
+        options.pauseDensity = 0.2;
+        options.slidesPerSection = 20;
+        options.variables = 10;
+        auto const deck = generateDeck(options);
+        auto const baseName = directory.filePath("deck");
+        QVERIFY(writeDeck(deck, baseName));
+        auto const presentationTemplate = loadTemplate(directory.filePath(generatedTemplateName));
+
+        std::map<QString, std::vector<double>> times;
+        std::map<QString, long> rssDelta;
+        auto const measure = [&times, &rssDelta](QString const& stage, std::function<void()> const& function) {
+            auto const rssBefore = currentRssKiB();
+            QElapsedTimer timer;
+            timer.start();
+            function();
+            times[stage].push_back(timer.nsecsElapsed() / 1e6);
+            rssDelta[stage] = std::max(rssDelta[stage], currentRssKiB() - rssBefore);
+        };
+        for(int repetition = 0; repetition < repetitions; repetition++) {
+            ParserOutput parserOutput = ParserError{};
+            measure("generateSlides", [&]{parserOutput = generateSlides(deck.text.toStdString(), directory.path());});
+            QVERIFY(parserOutput.successfull());
+
+            PresentationData data(parserOutput.slideList(), presentationTemplate);
+            measure("applyConfiguration", [&]{data.applyConfiguration(deck.configuration);});
+            measure("slideListDefaultApplied", [&]{data.slideListDefaultApplied();});
+
+            Presentation presentation;
+            presentation.setConfig(deck.configuration);
+            presentation.setData(data);
+            measure("findBox", [&]{
+                for(auto const& slide : presentation.slideList().vector) {
+                    for(auto const& box : slide->boxes()) {
+                        QVERIFY(presentation.findBox(box->id()));
+                    }
+                }
+            });
+
+            QImage image(160, 90, QImage::Format_ARGB32_Premultiplied);
+            QPainter painter(&image);
+            painter.setWindow(QRect(QPoint(0, 0), presentation.dimensions()));
+            SlideRenderer renderer(painter);
+            measure("paintSlide", [&]{
+                for(auto const& slide : presentation.data().slideListDefaultApplied().vector) {
+                    renderer.paintSlide(slide);
+                }
+            });
+        }
+        // the median of the repetitions, a single run disturbed by other processes does not count
+        for(auto& [stage, milliseconds] : times) {
+            std::nth_element(milliseconds.begin(), milliseconds.begin() + milliseconds.size() / 2, milliseconds.end());
+            mMeasurements[stage].push_back({slides, milliseconds[milliseconds.size() / 2], rssDelta[stage]});
+        }
+    }
+
+    QFile csv("scaling.csv");
+    if(csv.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        csv.write("stage,slides,boxes,milliseconds,rss_delta_kib\n");
+        for(auto const& [stage, measurements] : mMeasurements) {
+            for(auto const& measurement : measurements) {
+                csv.write(QString("%1,%2,%3,%4,%5\n").arg(stage).arg(measurement.slides).arg(measurement.slides * boxesPerSlide)
+                          .arg(measurement.milliseconds, 0, 'f', 3).arg(measurement.rssDeltaKiB).toUtf8());
+            }
+        }
+    }
+}
+
+void ScalingTest::testScaling() {
+    QFETCH(QString, stage);
+    QFETCH(double, expectedExponent);
+    auto const measurements = mMeasurements.find(stage);
+    QVERIFY(measurements != mMeasurements.end());
+    for(auto const& measurement : measurements->second) {
+        qDebug() << stage << measurement.slides << "slides:" << measurement.milliseconds << "ms, rss delta" << measurement.rssDeltaKiB << "KiB";
+    }
+    if(measurements->second.back().milliseconds < minimalMilliseconds) {
+        QSKIP("Stage is too fast to measure the growth.");
+    }
+    auto const exponent = growthExponent(measurements->second);
+    auto const message = QString("%1 grows with exponent %2, expected %3").arg(stage).arg(exponent, 0, 'f', 2).arg(expectedExponent);
+    if(qEnvironmentVariableIsSet("POTATO_SCALING_REPORT_ONLY")) {
+        if(exponent > expectedExponent + tolerance) {
+            qWarning() << message;
+        }
+        return;
+    }
+    QVERIFY2(exponent <= expectedExponent + tolerance, qPrintable(message));
+}
+
+void ScalingTest::testScaling_data() {
+    QTest::addColumn<QString>("stage");
+    QTest::addColumn<double>("expectedExponent");
+    QTest::newRow("generateSlides") << "generateSlides" << 1.0;
+    QTest::newRow("applyConfiguration") << "applyConfiguration" << 1.0;
+    QTest::newRow("slideListDefaultApplied") << "slideListDefaultApplied" << 1.0;
+    // one lookup per box
+    QTest::newRow("findBox") << "findBox" << 1.0;
+    QTest::newRow("paintSlide") << "paintSlide" << 1.0;
+}
@@ -0,0 +1,39 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef SCALINGTEST_H
+#define SCALINGTEST_H
+
+#include <QtTest/QTest>
+#include <map>
+#include <vector>
+
+// Runs the build pipeline on synthetic presentations of increasing size and
+// reports stages whose time grows faster than expected, e.g. quadratic instead of linear.
+// Every stage is measured several times and the median is used against noise. If the environment
+// variable POTATO_SCALING_REPORT_ONLY is set, a growth above the expected one is only reported,
+// e.g. on heavily loaded machines. The measurements are written to scaling.csv.
+class ScalingTest : public QObject
+{
+    Q_OBJECT
+public:
+    struct Measurement {
+        int slides;
+        double milliseconds;
+        // growth of the resident memory during the stage, the largest of the repetitions
+        long rssDeltaKiB;
+    };
+
+private Q_SLOTS:
+    void initTestCase();
+    void testScaling();
+    void testScaling_data();
+
+private:
+    std::map<QString, std::vector<Measurement>> mMeasurements;
+};
+
+#endif // SCALINGTEST_H
@@ -6,6 +6,9 @@
 
 #include "slide.h"
 
+#include <QCryptographicHash>
+#include <QDataStream>
+
 Slide::Slide()
     : mId{""}
 {
@@ -33,14 +36,16 @@ const Box::List &Slide::boxes() const
 void Slide::appendBox(std::shared_ptr<Box> box)
 {
     mBoxes.push_back(box);
+    invalidateFingerprint();
 }
 
 void Slide::setBoxes(std::vector<std::shared_ptr<Box>> boxes){
     mBoxes = boxes;
+    invalidateFingerprint();
 }
 
 bool Slide::empty() {
-    return (mBoxes.empty() && mTemplateBoxes.empty());
+    return (mBoxes.empty() && templateBoxes().empty());
 }
 
 QString const& Slide::id() const {
@@ -75,20 +80,19 @@ bool Slide::containsBox(const QString &id) const{
     return false;
 }
 
-void Slide::setTemplateBoxes(Box::List boxes){
+void Slide::setTemplateBoxes(std::shared_ptr<Box::List const> boxes){
     mTemplateBoxes = boxes;
+    invalidateFingerprint();
 }
 
-void Slide::appendTemplateBoxes(Box::Ptr box){
-    mTemplateBoxes.push_back(box);
-}
-
-Box::List Slide::templateBoxes() const{
-    return mTemplateBoxes;
+Box::List const& Slide::templateBoxes() const{
+    static Box::List const noBoxes;
+    return mTemplateBoxes ? *mTemplateBoxes : noBoxes;
 }
 
 void Slide::setVariables(Variables const& variables){
     mContext.mVariables = variables;
+    invalidateFingerprint();
 }
 
 Variables const& Slide::variables() const{
@@ -96,11 +100,13 @@ Variables const& Slide::variables() const{
 }
 
 Variables& Slide::variables() {
+    invalidateFingerprint();
     return mContext.mVariables;
 }
 
 void Slide::setVariable(QString const& name, QString const& value){
     mContext.mVariables[name] = value;
+    invalidateFingerprint();
 }
 
 int Slide::numberPauses() const {
@@ -117,6 +123,7 @@ int Slide::line() const {
 
 void Slide::setSlideClass(QString const& slideClass) {
     mClass = slideClass;
+    invalidateFingerprint();
 }
 
 QString Slide::slideClass() const {
@@ -149,6 +156,7 @@ std::optional<QString> Slide::removeVariable(QString const& variable) {
     }
     auto value = itVariable->second;
     mContext.mVariables.erase(itVariable);
+    invalidateFingerprint();
     return value;
 }
 
@@ -159,17 +167,67 @@ int Slide::pagenumber() const {
 void Slide::setTotalNumberPages(int pages) {
     mContext.mTotalnumberofPages = pages;
     mContext.mVariables["%{totalpages}"] = QString::number(pages);
+    invalidateFingerprint();
 }
 
 void Slide::setPagenumber(int pagenumber) {
     mContext.mPagenumber = pagenumber;
     mContext.mVariables["%{pagenumber}"] = QString::number(pagenumber);
+    invalidateFingerprint();
 }
 
 void Slide::setTableOfContents(TableOfContent tableofcontent) {
     mContext.mTableOfContent = tableofcontent;
+    invalidateFingerprint();
 }
 
 PresentationContext const& Slide::context() const {
     return mContext;
 }
+
+QByteArray Slide::fingerprint() const {
+    if(mFingerprint.isEmpty()) {
+        mFingerprint = boxesFingerprint();
+    }
+    // files can change on disk without the slide, their state is read every time
+    QByteArray resources;
+    QDataStream stream(&resources, QIODevice::WriteOnly);
+    for(auto const& box : templateBoxes()) {
+        box->writeResourceFingerprint(stream, mContext);
+    }
+    for(auto const& box : mBoxes) {
+        box->writeResourceFingerprint(stream, mContext);
+    }
+    if(resources.isEmpty()) {
+        return mFingerprint;
+    }
+    return QCryptographicHash::hash(mFingerprint + resources, QCryptographicHash::Sha1);
+}
+
+QByteArray Slide::boxesFingerprint() const {
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << mContext.mPagenumber << mContext.mTotalnumberofPages << int(mContext.mVariables.size());
+    for(auto const& [name, value] : mContext.mVariables) {
+        stream << name << value;
+    }
+    stream << int(mContext.mTableOfContent.sections.size());
+    for(auto const& section : mContext.mTableOfContent.sections) {
+        stream << section.name << section.startPage << section.length << int(section.subsection.size());
+        for(auto const& subsection : section.subsection) {
+            stream << subsection.name << subsection.startPage << subsection.length;
+        }
+    }
+    stream << int(templateBoxes().size());
+    for(auto const& box : templateBoxes()) {
+        box->writeFingerprint(stream, mContext);
+    }
+    for(auto const& box : mBoxes) {
+        box->writeFingerprint(stream, mContext);
+    }
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+void Slide::invalidateFingerprint() {
+    mFingerprint.clear();
+}
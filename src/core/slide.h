@@ -35,9 +35,10 @@ public:
     int line() const;
 
     // Template boxes are rendered in the background of the slide.
-    void setTemplateBoxes(Box::List boxes);
-    void appendTemplateBoxes(Box::Ptr box);
-    Box::List templateBoxes() const;
+    // The boxes are shared between all slides of a class and must not be changed,
+    // the slide specific values are passed by the context when drawing.
+    void setTemplateBoxes(std::shared_ptr<Box::List const> boxes);
+    Box::List const& templateBoxes() const;
 
     // The slide ID is the string after the "\slide" command, and is used to track
     // the slide when the document changes.
@@ -64,15 +65,26 @@ public:
     void setTableOfContents(TableOfContent tableofcontent);
     PresentationContext const& context() const;
 
+    // Digest of everything the slide is drawn from: the boxes, the template boxes and the context.
+    // Slides with equal fingerprints look the same. The part of the boxes and the context is computed once
+    // until the slide changes, whoever changes the boxes of the slide has to call invalidateFingerprint.
+    // The state of external resources like image files is added every time.
+    QByteArray fingerprint() const;
+    void invalidateFingerprint();
+
+private:
+    QByteArray boxesFingerprint() const;
+
 private:
     Box::List mBoxes;
-    Box::List mTemplateBoxes;
+    std::shared_ptr<Box::List const> mTemplateBoxes;
     QString mId;
     PresentationContext mContext;
     QString mClass;
     int mLine;
     BoxStyle mDefaultStyle;
     QString mDefinesClass;
+    mutable QByteArray mFingerprint;
 };
 
 Q_DECLARE_METATYPE(Slide::Ptr)
@@ -5,6 +5,11 @@
 */
 
 #include "sliderenderer.h"
+#include "displaylistcache.h"
+#include "imagefileembedder.h"
+#include "tracing.h"
+#include <QElapsedTimer>
+#include <typeinfo>
 
 namespace {
 
@@ -31,30 +36,118 @@ SlideRenderer::SlideRenderer(QPainter& painter)
 {
 }
 
+SlideRenderer SlideRenderer::exportRenderer(QPainter& painter, PresentationRenderHints additionalHints) {
+    SlideRenderer renderer(painter);
+    renderer.setRenderHints(static_cast<PresentationRenderHints>(static_cast<int>(TargetIsVectorSurface) | static_cast<int>(NoPreviewRendering)
+                                                                 | static_cast<int>(additionalHints)));
+    renderer.setDisplayListCache(&displayListCache());
+    return renderer;
+}
+
 void SlideRenderer::paintSlide(Slide::Ptr slide) const {
     paintSlide(slide, slide->numberPauses());
 }
 
 void SlideRenderer::paintSlide(Slide::Ptr slide, int pauseCount) const {
+    if(mDisplayListCache) {
+        paintSlide(*mDisplayListCache->recording(*this, slide), pauseCount);
+        return;
+    }
+    paintSlide(slide, pauseCount, [](Box::Ptr const&){return true;});
+}
+
+void SlideRenderer::paintSlide(Slide::Ptr slide, int pauseCount, BoxFilter const& filter) const {
     if(slide->empty()) {
         return;
     }
-    auto const templateBoxes = slide->templateBoxes();
-    auto const context = slide->context();
-    for(auto const& box: templateBoxes){
-        box->drawContent(mPainter, context, mRenderHints);
+    TraceSpan span("paintSlide", "paint");
+    std::optional<PresentationContext> contextStorage;
+    auto const& context = this->context(*slide, contextStorage);
+    for(auto const& box: slide->templateBoxes()){
+        if(filter(box)) {
+            drawBox(box, context);
+        }
     }
     auto const& boxes = slide->boxes();
     for(auto const& box: boxes){
         // boxes get only painted when pause counter conform
         auto const pause = box->pauseCounter();
 
-        if(boxGetPainted(pause, pauseCount)) {
-            box->drawContent(mPainter, context, mRenderHints);
+        if(boxGetPainted(pause, pauseCount) && filter(box)) {
+            drawBox(box, context);
+        }
+    }
+}
+
+RecordedSlide SlideRenderer::recordSlide(Slide::Ptr const& slide) const {
+    TraceSpan span("recordSlide", "paint");
+    RecordedSlide recorded;
+    if(slide->empty()) {
+        return recorded;
+    }
+    std::optional<PresentationContext> contextStorage;
+    auto const& context = this->context(*slide, contextStorage);
+    auto const record = [this, &context, &recorded](Box::Ptr const& box, std::optional<Pause> pause) {
+        TraceSpan span(typeid(*box).name(), "paint");
+        auto& recordedBox = recorded.boxes.emplace_back();
+        recordedBox.box = box;
+        recordedBox.pause = pause;
+        QPainter painter(&recordedBox.picture);
+        QElapsedTimer timer;
+        timer.start();
+        recordedBox.output = box->drawContent(painter, context, mRenderHints);
+        recordedBox.nanoseconds = timer.nsecsElapsed();
+    };
+    for(auto const& box: slide->templateBoxes()) {
+        record(box, std::nullopt);
+    }
+    for(auto const& box: slide->boxes()) {
+        record(box, box->pauseCounter());
+    }
+    return recorded;
+}
+
+void SlideRenderer::paintSlide(RecordedSlide const& slide, int pauseCount) const {
+    TraceSpan span("paintRecordedSlide", "paint");
+    for(auto const& box: slide.boxes) {
+        if(box.pause && !boxGetPainted(*box.pause, pauseCount)) {
+            continue;
+        }
+        mPainter.drawPicture(0, 0, box.picture);
+        if(mPaintTimes) {
+            mPaintTimes->push_back({box.box, box.nanoseconds});
+        }
+        if(mRenderOutputs) {
+            (*mRenderOutputs)[box.box->id()] = box.output;
         }
     }
 }
 
+void SlideRenderer::drawBox(Box::Ptr const& box, PresentationContext const& context) const {
+    TraceSpan span(typeid(*box).name(), "paint");
+    QElapsedTimer timer;
+    if(mPaintTimes) {
+        timer.start();
+    }
+    auto output = box->drawContent(mPainter, context, mRenderHints);
+    if(mPaintTimes) {
+        mPaintTimes->push_back({box, timer.nsecsElapsed()});
+    }
+    if(mRenderOutputs) {
+        (*mRenderOutputs)[box->id()] = std::move(output);
+    }
+}
+
+PresentationContext const& SlideRenderer::context(Slide const& slide, std::optional<PresentationContext>& storage) const {
+    if(mMaximalImageResolution <= 0 && !mImageFileEmbedder) {
+        return slide.context();
+    }
+    storage = slide.context();
+    storage->mMaximalImageResolution = mMaximalImageResolution;
+    storage->mImageFileEmbedder = mImageFileEmbedder;
+    return *storage;
+}
+
 QPainter& SlideRenderer::painter() const {
     return mPainter;
 }
@@ -62,3 +155,35 @@ QPainter& SlideRenderer::painter() const {
 void SlideRenderer::setRenderHints(PresentationRenderHints hints) {
     mRenderHints = hints;
 }
+
+PresentationRenderHints SlideRenderer::renderHints() const {
+    return mRenderHints;
+}
+
+void SlideRenderer::setDisplayListCache(DisplayListCache* cache) {
+    mDisplayListCache = cache;
+}
+
+void SlideRenderer::setMaximalImageResolution(double pixelsPerUnit) {
+    mMaximalImageResolution = pixelsPerUnit;
+}
+
+double SlideRenderer::maximalImageResolution() const {
+    return mMaximalImageResolution;
+}
+
+void SlideRenderer::setImageFileEmbedder(ImageFileEmbedder* embedder) {
+    mImageFileEmbedder = embedder;
+}
+
+ImageFileEmbedder* SlideRenderer::imageFileEmbedder() const {
+    return mImageFileEmbedder;
+}
+
+void SlideRenderer::setPaintTimes(std::vector<BoxPaintTime>* paintTimes) {
+    mPaintTimes = paintTimes;
+}
+
+void SlideRenderer::setRenderOutputs(BoxRenderOutputs* renderOutputs) {
+    mRenderOutputs = renderOutputs;
+}
@@ -10,24 +10,83 @@
 #include "box.h"
 
 #include<QPainter>
+#include <QPicture>
+#include <functional>
+
+// time a box took to draw, e.g. for the performance overlay
+struct BoxPaintTime {
+    Box::Ptr box;
+    qint64 nanoseconds;
+};
+
+// Boxes of one slide drawn into display lists, so slides with pauses draw every box once
+// and replay it on all pages it is shown on
+class DisplayListCache;
+
+struct RecordedSlide {
+    struct RecordedBox {
+        Box::Ptr box;
+        // template boxes are shown on every page
+        std::optional<Pause> pause;
+        QPicture picture;
+        BoxRenderOutput output;
+        // time the box took to draw while recording
+        qint64 nanoseconds = 0;
+    };
+    std::vector<RecordedBox> boxes;
+};
 
 class SlideRenderer
 {
 public:
     SlideRenderer();
     SlideRenderer(QPainter& painter);
+    // renderer of the exports: the boxes are drawn for vector surfaces without previews, once per slide
+    // into the display list cache, and replayed on the pages of all pauses
+    static SlideRenderer exportRenderer(QPainter& painter, PresentationRenderHints additionalHints = NoRenderHints);
 
 //    Painting Slide, if paintSlide(Slide::Ptr slide) is used every Box is painted
     void paintSlide(Slide::Ptr slide) const;
     void paintSlide(Slide::Ptr slide, int pauseCount) const;
+    // paints only the template and slide boxes for which filter returns true
+    using BoxFilter = std::function<bool(Box::Ptr const&)>;
+    void paintSlide(Slide::Ptr slide, int pauseCount, BoxFilter const& filter) const;
+    // draws every box of the slide once with the render hints of this renderer
+    RecordedSlide recordSlide(Slide::Ptr const& slide) const;
+    // paints the recorded boxes shown at pauseCount, like paintSlide(slide, pauseCount)
+    void paintSlide(RecordedSlide const& slide, int pauseCount) const;
 
     void setRenderHints(PresentationRenderHints hints);
+    PresentationRenderHints renderHints() const;
+    // paintSlide without filter replays the recordings of cache instead of drawing the boxes,
+    // nullptr draws the boxes every time
+    void setDisplayListCache(DisplayListCache* cache);
+    // images with more pixels per slide unit are downsampled, 0 draws them in the resolution of their files
+    void setMaximalImageResolution(double pixelsPerUnit);
+    double maximalImageResolution() const;
+    // image files are drawn as placeholders of embedder, nullptr draws the images
+    void setImageFileEmbedder(ImageFileEmbedder* embedder);
+    ImageFileEmbedder* imageFileEmbedder() const;
+    // appends the draw time of every painted box to paintTimes, nullptr stops the recording
+    void setPaintTimes(std::vector<BoxPaintTime>* paintTimes);
+    // stores the render output of every painted box, e.g. for hit tests, nullptr discards them
+    void setRenderOutputs(BoxRenderOutputs* renderOutputs);
 
     QPainter& painter() const;
 
+private:
+    void drawBox(Box::Ptr const& box, PresentationContext const& context) const;
+    // the context of the slide, with the settings of the renderer copied into storage if there are any
+    PresentationContext const& context(Slide const& slide, std::optional<PresentationContext>& storage) const;
+
 private:
     QPainter& mPainter;
     PresentationRenderHints mRenderHints = NoRenderHints;
+    std::vector<BoxPaintTime>* mPaintTimes = nullptr;
+    BoxRenderOutputs* mRenderOutputs = nullptr;
+    DisplayListCache* mDisplayListCache = nullptr;
+    double mMaximalImageResolution = 0;
+    ImageFileEmbedder* mImageFileEmbedder = nullptr;
 };
 
 #endif // PAINTER_H
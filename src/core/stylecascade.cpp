@@ -0,0 +1,271 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "stylecascade.h"
+#include "presentationdata.h"
+#include "utils.h"
+
+namespace {
+
+void applyGeometryToBoxIfSetInModel(Box::Ptr const& box, const BoxGeometry &modelGeometry) {
+    if(modelGeometry.left()) {
+        box->geometry().setLeft(modelGeometry.leftDisplay());
+    }
+    if(modelGeometry.top()) {
+        box->geometry().setTop(modelGeometry.topDisplay());
+    }
+    if(modelGeometry.width()) {
+        box->geometry().setWidth(modelGeometry.widthDisplay());
+    }
+    if(modelGeometry.height()) {
+        box->geometry().setHeight(modelGeometry.heightDisplay());
+    }
+    if(modelGeometry.angle()) {
+        box->geometry().setAngle(modelGeometry.angleDisplay());
+    }
+}
+
+// the appearance is merged into a copy, the box interns it once after all layers are applied
+void setStyleToBoxIfSetInModel(Box::Ptr const& box, BoxAppearance& appearance, BoxStyle const& modelStyle) {
+    auto const assignIfSet = [](auto& value, auto const& standard) {
+        if(standard) {
+            value = standard;
+        }
+    };
+
+    auto const& model = modelStyle.appearance();
+    assignIfSet(appearance.mFont, model.mFont);
+    assignIfSet(appearance.mFontSize, model.mFontSize);
+    assignIfSet(appearance.mFontWeight, model.mFontWeight);
+    assignIfSet(appearance.mColor, model.mColor);
+    assignIfSet(appearance.mBackgroundColor, model.mBackgroundColor);
+    assignIfSet(appearance.mAlignment, model.mAlignment);
+    assignIfSet(appearance.mLanguage, model.mLanguage);
+    assignIfSet(appearance.mHighlight, model.mHighlight);
+    assignIfSet(appearance.mLineSpacing, model.mLineSpacing);
+    assignIfSet(appearance.mOpacity, model.mOpacity);
+    assignIfSet(appearance.mPadding, model.mPadding);
+    assignIfSet(appearance.mBorderRadius, model.mBorderRadius);
+    assignIfSet(appearance.mTextMarker.color, model.mTextMarker.color);
+    assignIfSet(appearance.mTextMarker.fontWeight, model.mTextMarker.fontWeight);
+    assignIfSet(appearance.mBorder.width, model.mBorder.width);
+    assignIfSet(appearance.mBorder.style, model.mBorder.style);
+    assignIfSet(appearance.mBorder.color, model.mBorder.color);
+    if(modelStyle.mText && !modelStyle.mText->isEmpty()) {
+        box->style().mText = modelStyle.mText;
+    }
+}
+
+// the parts of a style resolving can change, appearances are compared by their shared instance
+bool sameResolvedStyle(BoxStyle const& style, BoxStyle const& other) {
+    return style.sameAppearance(other) && style.mText == other.mText && style.mGeometry.rect() == other.mGeometry.rect()
+            && style.mGeometry.angleDisplay() == other.mGeometry.angleDisplay();
+}
+
+// geometry of the standard template by box class
+BoxGeometry const& standardGeometry(QString const& boxClass) {
+    static auto const geometries = std::unordered_map<QString, BoxGeometry>{
+        {"title", BoxGeometry(QRect(50, 40, 1500, 100), 0)},
+        {"body", BoxGeometry(QRect(50, 150, 1500, 650), 0)},
+        {"code", BoxGeometry(QRect(50, 150, 1500, 650), 0)},
+        {"image", BoxGeometry(QRect(50, 150, 1500, 650), 0)},
+        {"right_column", BoxGeometry(QRect(830, 150, 720, 650), 0)},
+        {"left_column", BoxGeometry(QRect(50, 150, 720, 650), 0)},
+        {"fullscreen", BoxGeometry(QRect(0, 0, 1600, 900), 0)}
+    };
+    static auto const defaultGeometry = BoxGeometry(QRect(50, 200, 300, 100), 0);
+    auto const geometry = geometries.find(boxClass);
+    return geometry == geometries.end() ? defaultGeometry : geometry->second;
+}
+
+}
+
+void StyleCascade::compile(SlideList const& slides, ConfigBoxes const& config, ClassRules const& templateClasses) {
+    mTemplateClasses = templateClasses;
+    mDefinedClasses.clear();
+    mInlineStyles.clear();
+    mParsedStyles.clear();
+    mBoxes.clear();
+    mBoxesByConfigId.clear();
+    mDefiningBoxes.clear();
+    mBoxesByClass.clear();
+
+    // the inline properties are parsed once
+    std::vector<BoxEntry> entries;
+    for(auto const& slide : slides.vector) {
+        for(auto const& box : slide->boxes()) {
+            mInlineStyles[box.get()] = propertyMapToBoxStyle(box->properties());
+            mParsedStyles[box.get()] = box->style();
+            // like the slide list, the first box with an id is found
+            mBoxes.try_emplace(box->id(), BoxEntry{slide, box});
+            mBoxesByConfigId[box->configId()].push_back({slide, box});
+            entries.push_back({slide, box});
+        }
+    }
+
+    for(auto const& entry : entries) {
+        applyIdentity(entry.box);
+        if(entry.box->style().mClass) {
+            mBoxesByClass[entry.box->style().mClass.value()].push_back(entry);
+        }
+    }
+
+    for(auto const& entry : entries) {
+        if(!entry.box->style().mDefineclass) {
+            continue;
+        }
+        auto const key = ClassKey{entry.slide->definesClass(), entry.box->style().mDefineclass.value()};
+        mDefinedClasses[key] = compileDefinedClass(entry, config);
+        mDefiningBoxes[entry.box->id()] = key;
+    }
+
+    for(auto const& entry : entries) {
+        resolve(entry, config);
+    }
+}
+
+bool StyleCascade::update(QString const& boxId, ConfigBoxes const& config) {
+    auto const entry = mBoxes.find(boxId);
+    if(entry == mBoxes.end()) {
+        return false;
+    }
+    auto changed = false;
+    auto const definedClass = mDefiningBoxes.find(boxId);
+    if(definedClass != mDefiningBoxes.end()) {
+        auto const& key = definedClass->second;
+        // like compile, the class is made of the parsed style and not of a resolved one
+        resetStyle(entry->second);
+        mDefinedClasses[key] = compileDefinedClass(entry->second, config);
+        if(auto const dependentBoxes = mBoxesByClass.find(key.second); dependentBoxes != mBoxesByClass.end()) {
+            for(auto const& dependent : dependentBoxes->second) {
+                if(key.first.isEmpty() || dependent.slide->slideClass() == key.first) {
+                    changed = reresolve(dependent, config) || changed;
+                }
+            }
+        }
+    }
+    reresolve(entry->second, config);
+    // the pause copies of a box share its configuration and are shown on other pages
+    auto const copies = mBoxesByConfigId.find(entry->second.box->configId());
+    if(copies != mBoxesByConfigId.end()) {
+        for(auto const& copy : copies->second) {
+            if(copy.box != entry->second.box) {
+                changed = reresolve(copy, config) || changed;
+            }
+        }
+    }
+    return changed;
+}
+
+StyleCascade::ClassRules const& StyleCascade::definedClasses() const {
+    return mDefinedClasses;
+}
+
+Box::Ptr StyleCascade::findBox(QString const& id) const {
+    auto const entry = mBoxes.find(id);
+    if(entry == mBoxes.end()) {
+        return {};
+    }
+    return entry->second.box;
+}
+
+void StyleCascade::resolve(BoxEntry const& entry, ConfigBoxes const& config) const {
+    auto const& box = entry.box;
+    applyIdentity(box);
+    applyGeometryToBoxIfSetInModel(box, standardGeometry(box->style().getClass()));
+    auto appearance = box->style().appearance();
+    applyClassRules(entry, mTemplateClasses, appearance);
+    applyClassRules(entry, mDefinedClasses, appearance);
+    if(box->style().mClass == "title" && box->style().text().isEmpty()) {
+        box->style().mText = entry.slide->id();
+    }
+    applyConfiguration(box, config);
+    applyInlineStyle(box, appearance);
+    box->style().setAppearance(appearance);
+    entry.slide->invalidateFingerprint();
+}
+
+bool StyleCascade::reresolve(BoxEntry const& entry, ConfigBoxes const& config) const {
+    auto const previous = entry.box->style();
+    resetStyle(entry);
+    resolve(entry, config);
+    // the slide variables are applied once after compile, a resolved box needs them again
+    setStyleToBoxIfNotSettedAndSetInModel(entry.box, variablesToBoxStyle(entry.slide->variables()));
+    return !sameResolvedStyle(previous, entry.box->style());
+}
+
+void StyleCascade::resetStyle(BoxEntry const& entry) const {
+    if(auto const style = mParsedStyles.find(entry.box.get()); style != mParsedStyles.end()) {
+        entry.box->style() = style->second;
+    }
+}
+
+BoxStyle StyleCascade::compileDefinedClass(BoxEntry const& entry, ConfigBoxes const& config) const {
+    auto const& box = entry.box;
+    applyIdentity(box);
+    applyGeometryToBoxIfSetInModel(box, standardGeometry(box->style().getClass()));
+    auto appearance = box->style().appearance();
+    applyClassRules(entry, mTemplateClasses, appearance);
+    applyConfiguration(box, config);
+    applyInlineStyle(box, appearance);
+    box->style().setAppearance(appearance);
+    entry.slide->invalidateFingerprint();
+    return box->style();
+}
+
+void StyleCascade::applyIdentity(Box::Ptr const& box) const {
+    auto const& properties = box->properties();
+    if(auto const boxClass = properties.find("class"); boxClass != properties.end()) {
+        box->style().mClass = boxClass->second.mValue;
+    }
+    if(auto const id = properties.find("id"); id != properties.end()) {
+        box->style().mId = id->second.mValue;
+    }
+    if(auto const defineclass = properties.find("defineclass"); defineclass != properties.end()) {
+        box->style().mDefineclass = defineclass->second.mValue;
+    }
+}
+
+void StyleCascade::applyClassRules(BoxEntry const& entry, ClassRules const& rules, BoxAppearance& appearance) const {
+    auto const& boxClass = entry.box->style().mClass;
+    if(!boxClass || rules.empty()) {
+        return;
+    }
+    auto const apply = [&entry, &appearance](BoxStyle const& rule) {
+        applyGeometryToBoxIfSetInModel(entry.box, rule.mGeometry);
+        setStyleToBoxIfSetInModel(entry.box, appearance, rule);
+    };
+    if(auto const rule = rules.find({QString(), boxClass.value()}); rule != rules.end()) {
+        apply(rule->second);
+    }
+    auto const slideClass = entry.slide->slideClass();
+    if(slideClass.isEmpty()) {
+        return;
+    }
+    if(auto const rule = rules.find({slideClass, boxClass.value()}); rule != rules.end()) {
+        apply(rule->second);
+    }
+}
+
+void StyleCascade::applyConfiguration(Box::Ptr const& box, ConfigBoxes const& config) const {
+    auto const boxConfig = config.findRect(box->configId());
+    if(!boxConfig || boxConfig->empty()) {
+        return;
+    }
+    box->geometry().setLeft(boxConfig->rect.left());
+    box->geometry().setTop(boxConfig->rect.top());
+    box->geometry().setWidth(boxConfig->rect.width());
+    box->geometry().setHeight(boxConfig->rect.height());
+    box->geometry().setAngle(boxConfig->angle);
+}
+
+void StyleCascade::applyInlineStyle(Box::Ptr const& box, BoxAppearance& appearance) const {
+    auto const style = mInlineStyles.find(box.get());
+    if(style == mInlineStyles.end()) {
+        return;
+    }
+    setStyleToBoxIfSetInModel(box, appearance, style->second);
+}
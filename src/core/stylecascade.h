@@ -0,0 +1,73 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include "slide.h"
+#include "configboxes.h"
+
+struct SlideList;
+
+// Resolves the styles of the boxes of a presentation.
+// The rule sources are compiled once into typed BoxStyle values:
+// the standard template, the classes defined by the template,
+// the classes defined in the presentation and the inline properties of the boxes.
+// A box is then resolved with one lookup per layer in the order
+// standard template, template classes, defined classes, title, configuration, inline properties.
+class StyleCascade
+{
+public:
+    // slide class (empty if the class is defined for all slides) and box class
+    using ClassKey = std::pair<QString, QString>;
+    using ClassRules = std::map<ClassKey, BoxStyle>;
+
+    // compiles the rules of the slides and resolves all boxes,
+    // throws PorpertyConversionError if an inline property is invalid
+    void compile(SlideList const& slides, ConfigBoxes const& config, ClassRules const& templateClasses = {});
+
+    // resolves the box and its pause copies again, e.g. after its configuration changed.
+    // If the box defines a class, the rule and the boxes of this class are updated, too.
+    // Returns true if boxes other than the given one changed.
+    bool update(QString const& boxId, ConfigBoxes const& config);
+
+    ClassRules const& definedClasses() const;
+    // box of the compiled slides with the id, nullptr if there is none
+    Box::Ptr findBox(QString const& id) const;
+
+private:
+    struct BoxEntry {
+        Slide::Ptr slide;
+        Box::Ptr box;
+    };
+
+    void resolve(BoxEntry const& entry, ConfigBoxes const& config) const;
+    // resolves a compiled box again from its parsed style, returns true if it changed
+    bool reresolve(BoxEntry const& entry, ConfigBoxes const& config) const;
+    void resetStyle(BoxEntry const& entry) const;
+    // applies the layers a class definition is made of and returns the rule
+    BoxStyle compileDefinedClass(BoxEntry const& entry, ConfigBoxes const& config) const;
+    void applyIdentity(Box::Ptr const& box) const;
+    // the layers with an appearance merge it into appearance, it is interned once per resolved box
+    void applyClassRules(BoxEntry const& entry, ClassRules const& rules, BoxAppearance& appearance) const;
+    void applyConfiguration(Box::Ptr const& box, ConfigBoxes const& config) const;
+    void applyInlineStyle(Box::Ptr const& box, BoxAppearance& appearance) const;
+
+private:
+    ClassRules mTemplateClasses;
+    ClassRules mDefinedClasses;
+    std::unordered_map<Box const*, BoxStyle> mInlineStyles;
+    // style of the boxes as the parser left it, boxes are resolved again from it
+    std::unordered_map<Box const*, BoxStyle> mParsedStyles;
+    std::map<QString, BoxEntry> mBoxes;
+    // config id -> the box and its pause copies
+    std::map<QString, std::vector<BoxEntry>> mBoxesByConfigId;
+    // id of the defining box -> defined class
+    std::map<QString, ClassKey> mDefiningBoxes;
+    // box class -> boxes of this class, they depend on the rules of the class
+    std::map<QString, std::vector<BoxEntry>> mBoxesByClass;
+};
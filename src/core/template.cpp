@@ -6,7 +6,11 @@
 
 #include "template.h"
 #include "utils.h"
+#include "parser.h"
+#include "tracing.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QObject>
 #include <algorithm>
 
 namespace  {
@@ -27,6 +31,7 @@ Template::Template(const SlideList &slides)
 void Template::setConfig(ConfigBoxes config) {
     mData.applyConfiguration(config);
     mConfig = config;
+    clearTemplateBoxes();
 }
 
 Box::List Template::getTemplateSlide(QString slideId) const {
@@ -40,17 +45,51 @@ Box::List Template::getTemplateSlide(QString slideId) const {
     return boxes;
 }
 
+std::shared_ptr<Box::List const> Template::sharedTemplateSlide(QString const& slideClass) const {
+    std::lock_guard lock(mTemplateBoxesMutex);
+    auto& boxes = mTemplateSlides[slideClass];
+    if(!boxes) {
+        boxes = std::make_shared<Box::List const>(getTemplateSlide(slideClass));
+    }
+    return boxes;
+}
+
+std::shared_ptr<Box::List const> Template::templateBoxes(QString const& slideClass, BoxStyle const& variableStyle) const {
+    auto const templateSlide = sharedTemplateSlide(slideClass);
+    if(templateSlide->empty()) {
+        return templateSlide;
+    }
+    auto const key = DefaultsKey{slideClass, variableStyle.mAppearance, variableStyle.mText};
+    std::lock_guard lock(mTemplateBoxesMutex);
+    auto& boxes = mTemplateBoxes[key];
+    if(!boxes) {
+        auto defaultedBoxes = copy(*templateSlide);
+        for(auto const& box : defaultedBoxes) {
+            setStyleToBoxIfNotSettedAndSetInModel(box, variableStyle);
+        }
+        boxes = std::make_shared<Box::List const>(std::move(defaultedBoxes));
+    }
+    return boxes;
+}
+
+void Template::clearTemplateBoxes() {
+    std::lock_guard lock(mTemplateBoxesMutex);
+    mTemplateSlides.clear();
+    mTemplateBoxes.clear();
+}
+
 void Template::applyTemplate(SlideList& slideList) {
-    mData.applyDefinedClass(slideList, mConfig);
     for(auto const& slide: slideList.vector) {
-        auto const slideclass = slide->slideClass();
-        auto const boxlist = getTemplateSlide(slideclass);
-        slide->setTemplateBoxes(copy(boxlist));
+        slide->setTemplateBoxes(sharedTemplateSlide(slide->slideClass()));
         addVariableIfNotExist(slide->variables(), variables());
     }
 }
 
 
+StyleCascade::ClassRules const& Template::definedClasses() const {
+    return mData.styleCascade().definedClasses();
+}
+
 Variables const& Template::variables() {
     return mData.slides().lastSlide()->variables();
 }
@@ -58,6 +97,7 @@ Variables const& Template::variables() {
 void Template::setData(PresentationData data) {
     mData = data;
     mData.applyConfiguration(mConfig);
+    clearTemplateBoxes();
     for(auto const& slide: mData.slides().vector) {
         auto path = slide->removeVariable("{resourcepath}");
         if(!path) {
@@ -66,3 +106,28 @@ void Template::setData(PresentationData data) {
         slide->setVariable("%{templateresourcepath}", path.value());
     }
 }
+
+Template::Ptr loadTemplate(QString const& templateName) {
+    TraceSpan span("load template");
+    auto file = QFile(templateName + ".potato");
+    if(!file.open(QIODevice::ReadOnly)){
+        throw TemplateError{QObject::tr("Cannot load template %1.").arg(file.fileName())};
+    }
+    auto thisTemplate = std::make_shared<Template>();
+    try {
+        thisTemplate->setConfig(configFileName(templateName));
+    }  catch (ConfigError error) {
+        throw TemplateError{QObject::tr("Cannot load template %1.").arg(error.filename)};
+    }
+    auto const directoryPath = QFileInfo(templateName).absolutePath();
+    auto const parserOutput = generateSlides(file.readAll().toStdString(), directoryPath, true);
+    if(!parserOutput.successfull()) {
+        throw TemplateError{"Cannot load template \u26A0"};
+    }
+    try {
+        thisTemplate->setData(parserOutput.slideList());
+    }  catch (PorpertyConversionError & error) {
+        throw TemplateError{"Cannot load template: Line " + QString::number(error.line + 1) + ": " + error.message + " \u26A0"};
+    }
+    return thisTemplate;
+}
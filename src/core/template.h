@@ -7,6 +7,7 @@
 # pragma once
 
 #include <QPainter>
+#include <mutex>
 #include "slide.h"
 #include "configboxes.h"
 #include "presentationdata.h"
@@ -26,16 +27,33 @@ public:
     void setConfig(ConfigBoxes config);
     void setData(PresentationData data);
 
-    // apply template to a slide list
+    // apply template boxes and variables to a slide list
     void applyTemplate(SlideList& slideList);
+    // template boxes of a slide class with the defaults of variableStyle applied.
+    // The boxes are created once per slide class and defaults and shared by all slides using them.
+    std::shared_ptr<Box::List const> templateBoxes(QString const& slideClass, BoxStyle const& variableStyle) const;
+    // classes defined in the template, they are applied before the classes of the presentation
+    StyleCascade::ClassRules const& definedClasses() const;
 
     Variables const& variables();
 
 private:
     Box::List getTemplateSlide(QString slideId) const;
+    std::shared_ptr<Box::List const> sharedTemplateSlide(QString const& slideClass) const;
+    void clearTemplateBoxes();
 
 private:
+    // slide class, defaults of the slide variables
+    using DefaultsKey = std::tuple<QString, BoxAppearance::Ptr, std::optional<QString>>;
+
     PresentationData mData;
-    std::map<QString, Slide> mTemplateSlides;
     ConfigBoxes mConfig;
+    // the template is shared by presentations built in different threads
+    mutable std::mutex mTemplateBoxesMutex;
+    mutable std::map<QString, std::shared_ptr<Box::List const>> mTemplateSlides;
+    mutable std::map<DefaultsKey, std::shared_ptr<Box::List const>> mTemplateBoxes;
 };
+
+// reads the template <templateName>.potato and its configuration <templateName>.json
+// throws TemplateError if the template cannot be loaded
+Template::Ptr loadTemplate(QString const& templateName);
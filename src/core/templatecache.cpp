@@ -27,7 +27,7 @@ void TemplateCache::setTemplate(Template::Ptr newTemplate, QString path) {
     mPath = path;
     mTemplate = newTemplate;
     mWatcher->addPath(path + ".txt");
-    mWatcher->addPath(path + ".json");
+    mWatcher->addPath(configFileName(path));
 }
 
 void TemplateCache::resetTemplate() {
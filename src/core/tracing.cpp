@@ -0,0 +1,119 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "tracing.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QCoreApplication>
+#include <QStringList>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+namespace {
+constexpr std::size_t maxEvents = 200000;
+// weight of the newest span in the rolling average of a stage
+constexpr double averageWeight = 0.2;
+
+auto const startTime = std::chrono::steady_clock::now();
+}
+
+// box spans are named by typeid, which is mangled by some compilers
+QString readableSpanName(char const* name) {
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    auto const demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if(status == 0 && demangled) {
+        auto const readable = QString::fromLatin1(demangled);
+        std::free(demangled);
+        return readable;
+    }
+#endif
+    return QString::fromLatin1(name);
+}
+
+Tracer& tracer() {
+    static Tracer instance;
+    return instance;
+}
+
+void Tracer::setEnabled(bool enabled) {
+    mEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 Tracer::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Tracer::record(char const* name, char const* category, qint64 start, qint64 end) {
+    auto const thread = quint64(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    auto const duration = end - start;
+    std::lock_guard lock(mMutex);
+    if(mEvents.size() >= maxEvents) {
+        mEvents.pop_front();
+    }
+    mEvents.push_back({name, category, start, duration, thread});
+    auto& stage = mStages[name];
+    stage.average = stage.count == 0 ? duration : (1 - averageWeight) * stage.average + averageWeight * duration;
+    stage.count++;
+}
+
+void Tracer::clear() {
+    std::lock_guard lock(mMutex);
+    mEvents.clear();
+    mStages.clear();
+}
+
+bool Tracer::writeChromeTrace(QString const& fileName) const {
+    QJsonArray traceEvents;
+    {
+        std::lock_guard lock(mMutex);
+        for(auto const& event : mEvents) {
+            // complete events, the timestamps are in microseconds
+            traceEvents.append(QJsonObject{
+                {"name", readableSpanName(event.name)},
+                {"cat", QString::fromLatin1(event.category)},
+                {"ph", "X"},
+                {"ts", event.start / 1000.0},
+                {"dur", event.duration / 1000.0},
+                {"pid", QCoreApplication::applicationPid()},
+                {"tid", double(event.thread)}
+            });
+        }
+    }
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    auto const json = QJsonDocument(QJsonObject{{"traceEvents", traceEvents},
+                                                {"displayTimeUnit", "ms"}}).toJson(QJsonDocument::Compact);
+    return file.write(json) == json.size();
+}
+
+QString Tracer::summary(int maxStages) const {
+    std::vector<std::pair<std::string_view, double>> stages;
+    {
+        std::lock_guard lock(mMutex);
+        for(auto const& [name, stage] : mStages) {
+            stages.push_back({name, stage.average});
+        }
+    }
+    std::sort(stages.begin(), stages.end(), [](auto const& a, auto const& b){return a.second > b.second;});
+    QStringList parts;
+    for(int i = 0; i < int(stages.size()) && i < maxStages; i++) {
+        parts.append(QString("%1 %2 ms").arg(readableSpanName(stages[i].first.data()))
+                                        .arg(stages[i].second / 1e6, 0, 'f', 1));
+    }
+    return parts.join(QString::fromUtf8(" · "));
+}
@@ -0,0 +1,89 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string_view>
+
+// Records timing spans of the build pipeline, e.g. parsing, applying the configuration and painting.
+// Recording is off by default, a disabled span costs one atomic load.
+// The spans can be written in the Chrome trace event format (chrome://tracing, Perfetto)
+// and are summarised per stage with a rolling average.
+class Tracer
+{
+public:
+    struct Event {
+        // names and categories are string literals, they are not copied
+        char const* name;
+        char const* category;
+        qint64 start;
+        qint64 duration;
+        quint64 thread;
+    };
+
+    void setEnabled(bool enabled);
+    bool enabled() const {
+        return mEnabled.load(std::memory_order_relaxed);
+    }
+
+    // nanoseconds since the tracer was created
+    qint64 now() const;
+    // records a span measured by the caller, e.g. of an external process
+    void record(char const* name, char const* category, qint64 start, qint64 end);
+    void clear();
+
+    // writes the recorded spans as Chrome trace event JSON, returns false if the file cannot be written
+    bool writeChromeTrace(QString const& fileName) const;
+    // the slowest stages with their rolling average duration, e.g. "parse 3.1 ms · paint 1.2 ms"
+    QString summary(int maxStages = 4) const;
+
+private:
+    struct Stage {
+        double average = 0;
+        qint64 count = 0;
+    };
+
+    std::atomic<bool> mEnabled = false;
+    mutable std::mutex mMutex;
+    // the oldest spans are dropped to bound the memory
+    std::deque<Event> mEvents;
+    std::map<std::string_view, Stage> mStages;
+};
+
+Tracer& tracer();
+
+// readable form of a span name, e.g. the demangled type name of a box
+QString readableSpanName(char const* name);
+
+// Measures the time until the end of the scope.
+// Usage: TraceSpan span("parse", "parser");
+class TraceSpan
+{
+public:
+    TraceSpan(char const* name, char const* category = "build")
+        : mName(name)
+        , mCategory(category)
+        , mStart(tracer().enabled() ? tracer().now() : -1)
+    {
+    }
+    ~TraceSpan() {
+        if(mStart >= 0) {
+            tracer().record(mName, mCategory, mStart, tracer().now());
+        }
+    }
+    TraceSpan(TraceSpan const&) = delete;
+    TraceSpan& operator=(TraceSpan const&) = delete;
+
+private:
+    char const* mName;
+    char const* mCategory;
+    qint64 mStart;
+};
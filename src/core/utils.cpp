@@ -8,30 +8,43 @@
 #include <set>
 #include <algorithm>
 
+namespace {
+// like applyProperty, but the appearance is interned by the caller once all properties are applied
+void applyPropertyToAppearance(QString const& property, QString const& value, int line, BoxStyle & boxstyle, BoxAppearance& appearance);
+}
+
 BoxStyle propertyMapToBoxStyle(const Box::Properties &properties) {
     BoxStyle boxStyle;
+    auto appearance = boxStyle.appearance();
     for (auto const& entry: properties) {
-        applyProperty(entry.first, entry.second, boxStyle);
+        applyPropertyToAppearance(entry.first, entry.second.mValue, entry.second.mLine, boxStyle, appearance);
     }
+    boxStyle.setAppearance(appearance);
     return boxStyle;
 }
 
 BoxStyle variablesToBoxStyle(Variables const& variables) {
     BoxStyle boxStyle;
+    auto appearance = boxStyle.appearance();
     for (auto const& var: variables) {
         auto property = var.first;
         property.remove(0, 2);
         property.chop(1);
+        // an invalid variable leaves the appearance unchanged
+        auto changedAppearance = appearance;
         try {
-            applyProperty(property, var.second, 0, boxStyle);
+            applyPropertyToAppearance(property, var.second, 0, boxStyle, changedAppearance);
+            appearance = changedAppearance;
         }  catch (PorpertyConversionError) {
 
         }
     }
+    boxStyle.setAppearance(appearance);
     return boxStyle;
 }
 
-void applyProperty(QString const& property, const QString &value, int line, BoxStyle & boxstyle) {
+namespace {
+void applyPropertyToAppearance(QString const& property, QString const& value, int line, BoxStyle & boxstyle, BoxAppearance& appearance) {
     bool numberOk = true;
 
     if(property == "defineclass") {
@@ -52,25 +65,25 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
                 line
             };
         }
-        boxstyle.mColor = color;
+        appearance.mColor = color;
     }
     else if(property == "opacity") {
-        boxstyle.mOpacity = value.toDouble(&numberOk);
+        appearance.mOpacity = value.toDouble(&numberOk);
     }
     else if(property == "font-size") {
-        boxstyle.mFontSize = value.toInt(&numberOk);
+        appearance.mFontSize = value.toInt(&numberOk);
     }
     else if(property == "line-height") {
         if(value.toDouble() != 0) {
-            boxstyle.mLineSpacing = value.toDouble(&numberOk);
+            appearance.mLineSpacing = value.toDouble(&numberOk);
         }
     }
     else if(property == "font-weight") {
         if(QString(value) == "bold") {
-            boxstyle.mFontWeight = FontWeight::bold;
+            appearance.mFontWeight = FontWeight::bold;
         }
         else if(QString(value) == "normal") {
-            boxstyle.mFontWeight = FontWeight::normal;
+            appearance.mFontWeight = FontWeight::normal;
         }
         else {
             throw PorpertyConversionError {
@@ -80,7 +93,7 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
         }
     }
     else if(property == "font-family") {
-        boxstyle.mFont = QString(value);
+        appearance.mFont = QString(value);
     }
     else if(property == "id") {
         boxstyle.mId = value;
@@ -127,16 +140,16 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
     }
     else if(property == "text-align") {
         if(value == "left") {
-            boxstyle.mAlignment = Qt::AlignLeft;
+            appearance.mAlignment = Qt::AlignLeft;
         }
         else if(value == "right") {
-            boxstyle.mAlignment = Qt::AlignRight;
+            appearance.mAlignment = Qt::AlignRight;
         }
         else if(value == "center") {
-            boxstyle.mAlignment = Qt::AlignCenter;
+            appearance.mAlignment = Qt::AlignCenter;
         }
         else if(value == "justify") {
-            boxstyle.mAlignment = Qt::AlignJustify;
+            appearance.mAlignment = Qt::AlignJustify;
         }
         else {
             throw PorpertyConversionError {
@@ -146,14 +159,14 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
         }
     }
     else if(property == "language") {
-        boxstyle.mLanguage = QString(value);
+        appearance.mLanguage = QString(value);
     }
     else if(property == "highlight") {
         if(value == "false") {
-            boxstyle.mHighlight = false;
+            appearance.mHighlight = false;
         }
         else if(value == "true") {
-            boxstyle.mHighlight = true;
+            appearance.mHighlight = true;
         }
         else {
             throw PorpertyConversionError {
@@ -168,7 +181,7 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
         if(!color.isValid()) {
             throw PorpertyConversionError {"Invalid color", line};
         }
-        boxstyle.mBackgroundColor = color;
+        appearance.mBackgroundColor = color;
     }
     else if(property == "background-color") {
         QColor color;
@@ -176,13 +189,13 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
         if(!color.isValid()) {
             throw PorpertyConversionError {"Invalid color", line};
         }
-        boxstyle.mBackgroundColor = color;
+        appearance.mBackgroundColor = color;
     }
     else if(property == "padding") {
-        boxstyle.mPadding = value.toInt(&numberOk);
+        appearance.mPadding = value.toInt(&numberOk);
     }
     else if(property == "border-radius") {
-        boxstyle.mBorderRadius = value.toInt(&numberOk);
+        appearance.mBorderRadius = value.toInt(&numberOk);
     }
     else if(property == "border") {
         static auto const borderStyles = std::set<QString>{"solid", "dashed", "dotted", "double"};
@@ -197,9 +210,9 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
         if (values[0].endsWith("px") && values.length() >= 2) {
             auto value = values[0];
             value.chop(2);
-            boxstyle.mBorder.width = value.toInt(&borderOk);
+            appearance.mBorder.width = value.toInt(&borderOk);
             if(borderStyles.find(values[1]) != borderStyles.end()) {
-                boxstyle.mBorder.style = values[1];
+                appearance.mBorder.style = values[1];
             }
             else {
                 borderOk = false;
@@ -207,12 +220,12 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
             if (values.length() >= 3) {
                 auto const color = QColor(QString(values[2]));
                 borderOk = borderOk && color.isValid();
-                boxstyle.mBorder.color = color;
+                appearance.mBorder.color = color;
             }
         }
         else {
             if(borderStyles.find(values[0]) != borderStyles.end()) {
-                boxstyle.mBorder.style = values[0];
+                appearance.mBorder.style = values[0];
             }
             else {
                 borderOk = false;
@@ -220,7 +233,7 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
             if(values.length() >= 2) {
                 auto const color = QColor(QString(values[1]));
                 borderOk = borderOk && color.isValid();
-                boxstyle.mBorder.color = color;
+                appearance.mBorder.color = color;
             }
         }
         if(!borderOk) {
@@ -239,19 +252,19 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
             };
         }
         if(values[0] == "bold") {
-            boxstyle.mTextMarker.fontWeight = FontWeight::bold;
+            appearance.mTextMarker.fontWeight = FontWeight::bold;
         }
         else if(values[0] == "normal") {
-            boxstyle.mTextMarker.fontWeight = FontWeight::normal;
+            appearance.mTextMarker.fontWeight = FontWeight::normal;
         }
         else {
-            boxstyle.mTextMarker.color = QColor(QString(values[0]));
+            appearance.mTextMarker.color = QColor(QString(values[0]));
             if(values.length() > 1) {
                 if(values[1] == "bold") {
-                    boxstyle.mTextMarker.fontWeight = FontWeight::bold;
+                    appearance.mTextMarker.fontWeight = FontWeight::bold;
                 }
                 else if(values[1] == "normal") {
-                    boxstyle.mTextMarker.fontWeight = FontWeight::normal;
+                    appearance.mTextMarker.fontWeight = FontWeight::normal;
                 }
             }
         }
@@ -269,11 +282,50 @@ void applyProperty(QString const& property, const QString &value, int line, BoxS
         };
     }
 }
+}
+
+void applyProperty(QString const& property, const QString &value, int line, BoxStyle & boxstyle) {
+    auto appearance = boxstyle.appearance();
+    applyPropertyToAppearance(property, value, line, boxstyle, appearance);
+    boxstyle.setAppearance(appearance);
+}
 
 void applyProperty(QString const& property, PropertyEntry const& entry, BoxStyle & boxstyle) {
     applyProperty(property, entry.mValue, entry.mLine, boxstyle);
 }
 
+void setStyleToBoxIfNotSettedAndSetInModel(Box::Ptr const& box, BoxStyle const& modelStyle) {
+    auto const assignIfSet = [](auto& value, auto const& standard) {
+        if(standard && !value) {
+            value = standard;
+        }
+    };
+
+    auto appearance = box->style().appearance();
+    auto const& model = modelStyle.appearance();
+    assignIfSet(appearance.mFont, model.mFont);
+    assignIfSet(appearance.mFontSize, model.mFontSize);
+    assignIfSet(appearance.mFontWeight, model.mFontWeight);
+    assignIfSet(appearance.mColor, model.mColor);
+    assignIfSet(appearance.mBackgroundColor, model.mBackgroundColor);
+    assignIfSet(appearance.mAlignment, model.mAlignment);
+    assignIfSet(appearance.mLanguage, model.mLanguage);
+    assignIfSet(appearance.mHighlight, model.mHighlight);
+    assignIfSet(appearance.mLineSpacing, model.mLineSpacing);
+    assignIfSet(appearance.mOpacity, model.mOpacity);
+    assignIfSet(appearance.mPadding, model.mPadding);
+    assignIfSet(appearance.mBorderRadius, model.mBorderRadius);
+    assignIfSet(appearance.mTextMarker.color, model.mTextMarker.color);
+    assignIfSet(appearance.mTextMarker.fontWeight, model.mTextMarker.fontWeight);
+    assignIfSet(appearance.mBorder.width, model.mBorder.width);
+    assignIfSet(appearance.mBorder.style, model.mBorder.style);
+    assignIfSet(appearance.mBorder.color, model.mBorder.color);
+    box->style().setAppearance(appearance);
+    if(modelStyle.mText && !modelStyle.mText->isEmpty()) {
+        box->style().mText = modelStyle.mText;
+    }
+}
+
 Box::List copy(Box::List const& input) {
     Box::List copiedList(input.size());
     std::ranges::transform(input.begin(), input.end(), copiedList.begin(), [](auto const& element) { return element->clone(); });
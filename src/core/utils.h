@@ -13,4 +13,7 @@ BoxStyle variablesToBoxStyle(Variables const& variables);
 void applyProperty(QString const& property, QString const& value, int line, BoxStyle & boxstyle);
 void applyProperty(QString const& property, PropertyEntry const& entry, BoxStyle & boxstyle);
 
+// sets the values of modelStyle the box has not set yet, e.g. the defaults of the slide variables
+void setStyleToBoxIfNotSettedAndSetInModel(Box::Ptr const& box, BoxStyle const& modelStyle);
+
 Box::List copy(Box::List const& input);
@@ -46,7 +46,7 @@ BoxGeometry BoxTransformation::makeScaleTransformation(QPoint mousePos){
             auto const localMouse = geometry.transform(bottomRight).inverted().map(mousePos);
             rect.setTopLeft(localMouse);
 
-            if(mSnapping && geometry.angle() == 0) {
+            if(mSnapping && geometry.angleDisplay() == 0) {
                 auto snapX = mSnapping.value().snapX(rect.left());
                 auto snapY = mSnapping.value().snapY(rect.top());
                 if(snapX) {
@@ -69,7 +69,7 @@ BoxGeometry BoxTransformation::makeScaleTransformation(QPoint mousePos){
             auto const localMouse = geometry.transform(bottomLeft).inverted().map(mousePos);
             rect.setTopRight(localMouse);
 
-            if(mSnapping && geometry.angle() == 0) {
+            if(mSnapping && geometry.angleDisplay() == 0) {
                 auto snapX = mSnapping.value().snapX(rect.right());
                 auto snapY = mSnapping.value().snapY(rect.top());
                 if(snapX) {
@@ -92,7 +92,7 @@ BoxGeometry BoxTransformation::makeScaleTransformation(QPoint mousePos){
             auto const localMouse = geometry.transform(topRight).inverted().map(mousePos);
             rect.setBottomLeft(localMouse);
 
-            if(mSnapping && geometry.angle() == 0) {
+            if(mSnapping && geometry.angleDisplay() == 0) {
                 auto snapX = mSnapping.value().snapX(rect.left());
                 auto snapY = mSnapping.value().snapY(rect.bottom());
                 if(snapX) {
@@ -115,7 +115,7 @@ BoxGeometry BoxTransformation::makeScaleTransformation(QPoint mousePos){
             auto const localMouse = geometry.transform(topLeft).inverted().map(mousePos);
             rect.setBottomRight(localMouse);
 
-            if(mSnapping && geometry.angle() == 0) {
+            if(mSnapping && geometry.angleDisplay() == 0) {
                 auto snapX = mSnapping.value().snapX(rect.right());
                 auto snapY = mSnapping.value().snapY(rect.bottom());
                 if(snapX) {
@@ -138,7 +138,7 @@ BoxGeometry BoxTransformation::makeScaleTransformation(QPoint mousePos){
             auto const localMouse = geometry.transform(bottomLeft).inverted().map(mousePos);
             rect.setTop(localMouse.y());
 
-            if(mSnapping && geometry.angle() == 0) {
+            if(mSnapping && geometry.angleDisplay() == 0) {
                 auto snapY = mSnapping.value().snapY(rect.top());
                 if(snapY) {
                     rect.setTop(snapY.value());
@@ -156,7 +156,7 @@ BoxGeometry BoxTransformation::makeScaleTransformation(QPoint mousePos){
             auto const localMouse = geometry.transform(topLeft).inverted().map(mousePos);
             rect.setBottom(localMouse.y());
 
-            if(mSnapping && geometry.angle() == 0) {
+            if(mSnapping && geometry.angleDisplay() == 0) {
                 auto snapY = mSnapping.value().snapY(rect.bottom());
                 if(snapY) {
                     rect.setBottom(snapY.value());
@@ -174,7 +174,7 @@ BoxGeometry BoxTransformation::makeScaleTransformation(QPoint mousePos){
             auto const localMouse = geometry.transform(topRight).inverted().map(mousePos);
             rect.setLeft(localMouse.x());
 
-            if(mSnapping && geometry.angle() == 0) {
+            if(mSnapping && geometry.angleDisplay() == 0) {
                 auto snapX = mSnapping.value().snapX(rect.left());
                 if(snapX) {
                     rect.setLeft(snapX.value());
@@ -192,7 +192,7 @@ BoxGeometry BoxTransformation::makeScaleTransformation(QPoint mousePos){
             auto const localMouse = geometry.transform(topLeft).inverted().map(mousePos);
             rect.setRight(localMouse.x());
 
-            if(mSnapping && geometry.angle() == 0) {
+            if(mSnapping && geometry.angleDisplay() == 0) {
                 auto snapX = mSnapping.value().snapX(rect.right());
                 if(snapX) {
                     rect.setRight(snapX.value());
@@ -206,7 +206,7 @@ BoxGeometry BoxTransformation::makeScaleTransformation(QPoint mousePos){
         }
         case pointPosition::inBox:{
             rect.translate(mousePos - mStartMousePosition);
-            if(mSnapping && geometry.angle() == 0) {
+            if(mSnapping && geometry.angleDisplay() == 0) {
                 rect = makeSnappingTranslating(rect);
             }
             geometry.setRect(rect);
@@ -247,7 +247,7 @@ BoxGeometry BoxTransformation::makeRotateTransformation(QPoint mousePos){
     case pointPosition::inBox:{
         auto rect = geometry.rect();
         rect.translate(mousePos - mStartMousePosition);
-        if(mSnapping && geometry.angle() == 0) {
+        if(mSnapping && geometry.angleDisplay() == 0) {
             rect = makeSnappingTranslating(rect);
         }
         geometry.setRect(rect);
@@ -293,16 +293,16 @@ void BoxTransformation::setSnapping(Snapping snapping) {
 }
 
 QRect BoxTransformation::makeSnappingTranslating(QRect rect) {
-    auto const leftSnap = mSnapping.value().snapX(rect.left());
-    if(leftSnap.has_value()) {
-        rect.moveLeft(leftSnap.value());
-        mXGuide = leftSnap.value();
+    auto const xSnap = mSnapping.value().snapRectX(rect);
+    if(xSnap.has_value()) {
+        rect.translate(xSnap->offset, 0);
+        mXGuide = xSnap->guide;
     }
 
-    auto const topSnap = mSnapping.value().snapY(rect.top());
-    if(topSnap.has_value()) {
-        rect.moveTop(topSnap.value());
-        mYGuide = topSnap.value();
+    auto const ySnap = mSnapping.value().snapRectY(rect);
+    if(ySnap.has_value()) {
+        rect.translate(0, ySnap->offset);
+        mYGuide = ySnap->guide;
     }
 
     auto const middleSnapping = mSnapping->snapYMiddle(rect.center().x());
@@ -7,13 +7,21 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <iostream>
 #include <vector>
 #include "box.h"
 #include "parser.h"
 #include "slide.h"
 #include "sliderenderer.h"
+#include "configboxes.h"
+#include "tracing.h"
+#include "imageexporter.h"
+#include "template.h"
+#include "presentation.h"
 
 enum keywords{
     tile,
@@ -21,13 +29,147 @@ enum keywords{
     text
 };
 
+namespace {
+// builds the presentation of a .potato file and its configuration without the editor,
+// returns nullptr and sets error if it cannot be built
+std::shared_ptr<Presentation> loadPresentation(QString const& fileName, QString& error) {
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        error = "Cannot read " + fileName;
+        return {};
+    }
+    auto const fileInfo = QFileInfo(fileName);
+    auto const directory = fileInfo.absolutePath();
+    auto const parserOutput = generateSlides(file.readAll().toStdString(), directory);
+    if(!parserOutput.successfull()) {
+        error = QString("Line %1: %2").arg(parserOutput.parserError().line + 1).arg(parserOutput.parserError().message);
+        return {};
+    }
+    try {
+        Template::Ptr presentationTemplate;
+        auto templateName = parserOutput.preamble().templateName;
+        if(!templateName.isEmpty()) {
+            if(!QDir::isAbsolutePath(templateName)) {
+                templateName = directory + "/" + templateName;
+            }
+            presentationTemplate = loadTemplate(templateName);
+        }
+        auto presentation = std::make_shared<Presentation>();
+        auto const configuration = configFileName(directory + "/" + fileInfo.completeBaseName());
+        if(QFile::exists(configuration)) {
+            presentation->setConfig({configuration});
+        }
+        presentation->setData({parserOutput.slideList(), presentationTemplate});
+        return presentation;
+    }  catch (ConfigError const& configError) {
+        error = configError.errorMessage;
+    }  catch (TemplateError const& templateError) {
+        error = templateError.message;
+    }  catch (PorpertyConversionError const& conversionError) {
+        error = QString("Line %1: %2").arg(conversionError.line + 1).arg(conversionError.message);
+    }
+    return {};
+}
+
+// parses "<first>-<last>" or "<slide>", counted from 1, into the range of the options
+bool setSlideRange(QString const& range, ImageExportOptions& options) {
+    auto const parts = range.split('-');
+    bool firstOk = true, lastOk = true;
+    options.firstSlide = parts[0].isEmpty() ? 0 : parts[0].toInt(&firstOk) - 1;
+    options.lastSlide = parts.size() == 1 ? options.firstSlide : parts[1].isEmpty() ? -1 : parts[1].toInt(&lastOk) - 1;
+    return parts.size() <= 2 && firstOk && lastOk;
+}
+}
+
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
     QCoreApplication::setOrganizationName("Potato");
     QCoreApplication::setApplicationName("Potato Presenter");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption convertConfigOption("convert-config",
+            QCoreApplication::translate("main", "Convert the configuration file <source> to <destination> with the format json or binary. "
+                                                "Presentations read binary configurations from <name>.ppcb."),
+            "format");
+    parser.addOption(convertConfigOption);
+    QCommandLineOption traceOption("trace",
+            QCoreApplication::translate("main", "Record the build stages and write them as Chrome trace to <file> on exit."),
+            "file");
+    parser.addOption(traceOption);
+    QCommandLineOption exportImagesOption("export-images",
+            QCoreApplication::translate("main", "Export the slides of the presentation <source> as images to <directory> without opening a window, "
+                                                "e.g. with QT_QPA_PLATFORM=offscreen."),
+            "directory");
+    QCommandLineOption formatOption("format", QCoreApplication::translate("main", "Image format, png or jpg."), "format", "png");
+    QCommandLineOption dpiOption("dpi", QCoreApplication::translate("main", "Resolution of the images."), "dpi", "150");
+    QCommandLineOption slidesOption("slides", QCoreApplication::translate("main", "Exported slides, e.g. 3-7, counted from 1."), "range");
+    QCommandLineOption noPausesOption("no-pauses", QCoreApplication::translate("main", "Export only the complete slides."));
+    QCommandLineOption threadsOption("threads", QCoreApplication::translate("main", "Number of threads, 0 for one per core."), "count", "0");
+    parser.addOptions({exportImagesOption, formatOption, dpiOption, slidesOption, noPausesOption, threadsOption});
+    parser.addPositionalArgument("source", QCoreApplication::translate("main", "Configuration file to convert or presentation to export."), "[source]");
+    parser.addPositionalArgument("destination", QCoreApplication::translate("main", "Converted configuration file."), "[destination]");
+    parser.process(a);
+    if(parser.isSet(convertConfigOption)) {
+        auto const format = parser.value(convertConfigOption);
+        auto const arguments = parser.positionalArguments();
+        if(arguments.size() != 2 || (format != "json" && format != "binary")) {
+            parser.showHelp(1);
+        }
+        try {
+            convertConfig(arguments[0], arguments[1],
+                          format == "binary" ? ConfigBoxes::Format::Binary : ConfigBoxes::Format::Json);
+        }  catch (ConfigError error) {
+            std::cerr << error.errorMessage.toStdString() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if(parser.isSet(traceOption)) {
+        tracer().setEnabled(true);
+    }
+
+    if(parser.isSet(exportImagesOption)) {
+        auto const arguments = parser.positionalArguments();
+        if(arguments.size() != 1) {
+            parser.showHelp(1);
+        }
+        ImageExportOptions options;
+        options.directory = parser.value(exportImagesOption);
+        options.baseName = QFileInfo(arguments[0]).completeBaseName();
+        options.format = parser.value(formatOption).toUtf8();
+        options.dpi = parser.value(dpiOption).toInt();
+        options.pauses = !parser.isSet(noPausesOption);
+        options.threads = parser.value(threadsOption).toInt();
+        if(options.dpi <= 0 || (parser.isSet(slidesOption) && !setSlideRange(parser.value(slidesOption), options))) {
+            parser.showHelp(1);
+        }
+        QString error;
+        auto const presentation = loadPresentation(arguments[0], error);
+        if(!presentation) {
+            std::cerr << error.toStdString() << std::endl;
+            return 1;
+        }
+        auto const result = ImageExporter().exportImages(*presentation, options);
+        for(auto const& failedFile : result.failedFiles) {
+            std::cerr << "Cannot write " << failedFile.toStdString() << std::endl;
+        }
+        std::cout << result.images << " images, " << result.nanoseconds / 1e6 << " ms, "
+                  << result.imagesPerSecond() << " images/s, " << result.megabytesPerSecond() << " MB/s" << std::endl;
+        if(parser.isSet(traceOption) && !tracer().writeChromeTrace(parser.value(traceOption))) {
+            std::cerr << "Cannot write trace " << parser.value(traceOption).toStdString() << std::endl;
+        }
+        return result.success() ? 0 : 1;
+    }
+
     MainWindow w;
     w.show();
-    return a.exec();
+    auto const ret = a.exec();
+    if(parser.isSet(traceOption) && !tracer().writeChromeTrace(parser.value(traceOption))) {
+        std::cerr << "Cannot write trace " << parser.value(traceOption).toStdString() << std::endl;
+    }
+    return ret;
 }
 
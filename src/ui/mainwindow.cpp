@@ -26,25 +26,30 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QSettings>
+#include <QElapsedTimer>
+#include <QInputDialog>
+#include <QApplication>
 
 #include <functional>
 #include <algorithm>
 
 #include "latexcachemanager.h"
 #include "cachemanager.h"
+#include "displaylistcache.h"
 #include "slidelistmodel.h"
 #include "slidelistdelegate.h"
 #include "templatelistdelegate.h"
 #include "pdfcreator.h"
+#include "imageexporter.h"
 #include "utils.h"
 #include "potatoformatvisitor.h"
 #include "transformboxundo.h"
+#include "tracing.h"
 #include "version.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
-    , mLastAutosave(QDateTime::currentDateTime())
 {
     ui->setupUi(this);
     setWindowIcon(QIcon(":/potato_logo.png"));
@@ -105,8 +110,19 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::exportPDFHandout);
     connect(ui->actionExport_PDF_Handout_as, &QAction::triggered,
             this, &MainWindow::exportPDFHandoutAs);
+    connect(ui->actionExport_Images, &QAction::triggered,
+            this, &MainWindow::exportImages);
+    connect(ui->actionPdf_Image_Resolution, &QAction::triggered,
+            this, &MainWindow::setPdfImageResolution);
+    mPdfCreator.setMaximalImageDpi(QSettings().value("pdfImageDpi", 0).toInt());
     connect(ui->actionReload_Resources, &QAction::triggered,
             this, &MainWindow::resetCacheManager);
+    connect(ui->actionShow_Build_Timings, &QAction::toggled,
+            this, &MainWindow::setTracingEnabled);
+    connect(ui->actionExport_Build_Trace, &QAction::triggered,
+            this, &MainWindow::exportTrace);
+    connect(ui->actionShow_Performance_Overlay, &QAction::toggled,
+            mSlideWidget, &SlideWidget::setPerformanceOverlay);
 
     connect(ui->actionUndo, &QAction::triggered,
             mSlideWidget, &SlideWidget::undo);
@@ -138,11 +154,11 @@ MainWindow::MainWindow(QWidget *parent)
 
 //    setup CacheManager
     connect(&cacheManager(), &LatexCacheManager::conversionFinished,
-            mSlideWidget, QOverload<>::of(&SlideWidget::update));
+            mSlideWidget, &SlideWidget::invalidate);
 
-    CacheManager<QPixmap>::instance().setCallback([this](QString){mSlideWidget->update();});
-    CacheManager<QSvgRenderer>::instance().setCallback([this](QString){mSlideWidget->update();});
-    CacheManager<PixMapVector>::instance().setCallback([this](QString){mSlideWidget->update();});
+    CacheManager<QPixmap>::instance().setCallback([this](QString){displayListCache().clear(); mSlideWidget->invalidate();});
+    CacheManager<QSvgRenderer>::instance().setCallback([this](QString){displayListCache().clear(); mSlideWidget->invalidate();});
+    CacheManager<PixMapVector>::instance().setCallback([this](QString){displayListCache().clear(); mSlideWidget->invalidate();});
 
 
 //    setup bar with error messages, snapping and couple button
@@ -172,6 +188,16 @@ MainWindow::MainWindow(QWidget *parent)
             this, [this](){mSlideWidget->setSnapping(mSnappingButton->isChecked());});
 
 
+//    setup build timings in the status bar
+    mTraceSummary = new QLabel(this);
+    ui->statusbar->addPermanentWidget(mTraceSummary);
+    connect(&mTraceTimer, &QTimer::timeout,
+            this, [this](){mTraceSummary->setText(tracer().summary());});
+    // tracing can be enabled on the command line
+    ui->actionShow_Build_Timings->setChecked(tracer().enabled());
+    setTracingEnabled(tracer().enabled());
+
+
 //    coupling between document and slide widget selection
     connect(mSlideWidget, &SlideWidget::selectionChanged,
             this, [this](Slide::Ptr slide){
@@ -205,15 +231,17 @@ MainWindow::MainWindow(QWidget *parent)
             ":/templates/templates/red_line",
             ":/templates/templates/astro",
             ":/templates/templates/astro2"};
-    auto const presentationList = generateTemplatePresentationList(dirList);
     mTemplateModel = new TemplateListModel(this);
-    mTemplateModel->setPresentationList(presentationList);
+    mTemplateModel->loadTemplates(dirList);
     ui->templateList->setModel(mTemplateModel);
     TemplateListDelegate *delegateTemplate = new TemplateListDelegate(this);
     ui->templateList->setItemDelegate(delegateTemplate);
+    // size of the entries changes when the template is loaded
+    connect(mTemplateModel, &TemplateListModel::dataChanged,
+            ui->templateList, &QListView::doItemsLayout);
     connect(ui->templateList, &QListView::clicked,
-            this, [this, dirList]{
-                mTemplatePath = dirList[ui->templateList->currentIndex().row()];
+            this, [this](QModelIndex const& index){
+                mTemplatePath = mTemplateModel->directory(index.row());
                 openCreatePresentationDialog();
             });
     connect(ui->emptyPresentationButton, &QPushButton::clicked,
@@ -266,10 +294,14 @@ void MainWindow::closeEvent(QCloseEvent *event) {
 }
 
 void MainWindow::fileChanged() {
+    TraceSpan span("fileChanged");
     auto iface = qobject_cast<KTextEditor::MarkInterface*>(mDoc);
     iface->clearMarks();
     auto const text = mDoc->text().toUtf8().toStdString();
+    QElapsedTimer buildTimer;
+    buildTimer.start();
     auto const parserOutput = generateSlides(text, fileDirectory());
+    auto const parseTime = buildTimer.nsecsElapsed();
     if(parserOutput.successfull()) {
         auto const slides = parserOutput.slideList();
         auto const preamble = parserOutput.preamble();
@@ -292,7 +324,9 @@ void MainWindow::fileChanged() {
             }
         }
         try {
+            buildTimer.restart();
             mPresentation->setData({slides, presentationTemplate});
+            mSlideWidget->setBuildDurations(parseTime, buildTimer.nsecsElapsed());
         }  catch (PorpertyConversionError error) {
             mErrorOutput->setText("Line " + QString::number(error.line + 1) + ": " + error.message + " \u26A0");
             iface->addMark(error.line, KTextEditor::MarkInterface::MarkTypes::Error);
@@ -308,46 +342,21 @@ void MainWindow::fileChanged() {
     }
 
     mSlideWidget->updateSlideId();
-    mSlideWidget->update();
+    mSlideWidget->invalidate();
     mSlideModel->setPresentation(mPresentation);
     auto const index = mSlideModel->index(mSlideWidget->pageNumber());
     ui->pagePreview->selectionModel()->select(index, QItemSelectionModel::ClearAndSelect);
     ui->pagePreview->scrollTo(index);
-    autosave();
 }
 
 std::shared_ptr<Template> MainWindow::readTemplate(QString templateName) const {
     if(templateName.isEmpty()) {
         return {};
     }
-    auto file = QFile(templateName + ".potato");
-    if(!file.open(QIODevice::ReadOnly)){
-        mErrorOutput->setText(tr("Cannot load template %1.").arg(file.fileName()));
-        return {};
-    }
-    auto thisTemplate = std::make_shared<Template>();
     try {
-        thisTemplate->setConfig(templateName + ".json");
-    }  catch (ConfigError error) {
-        mErrorOutput->setText(tr("Cannot load template %1.").arg(error.filename));
-        return {};
-    }
-    auto const directoryPath = QFileInfo(templateName).absolutePath();
-    auto const parserOutput = generateSlides(file.readAll().toStdString(), directoryPath, true);
-
-    if(parserOutput.successfull()) {
-        auto const slides = parserOutput.slideList();
-        try {
-            thisTemplate->setData(slides);
-        }  catch (PorpertyConversionError & error) {
-            mErrorOutput->setText("Cannot load template: Line " + QString::number(error.line + 1) + ": " + error.message + " \u26A0");
-            return {};
-        }
-        return thisTemplate;
-    }
-    else {
-        auto const error = parserOutput.parserError();
-        mErrorOutput->setText("Cannot load template \u26A0");
+        return loadTemplate(templateName);
+    }  catch (TemplateError error) {
+        mErrorOutput->setText(error.message);
         return {};
     }
 }
@@ -369,7 +378,7 @@ void MainWindow::openInputFile(QString filename) {
 
 void MainWindow::askToRecoverAutosave() {
     // recover if file was not properly closed and autosave still exists
-    if(QFile::exists(autosaveTextFile()) || QFile::exists(autosaveJsonFile())) {
+    if(QFile::exists(autosaveJournalFile())) {
         auto const ret = QMessageBox::information(this, tr("File was not probably closed."),
                         tr("File was not properly closed. Do you want to recover?"),
                         QMessageBox::Ok, QMessageBox::Cancel);
@@ -387,20 +396,24 @@ void MainWindow::askToRecoverAutosave() {
 }
 
 void MainWindow::recoverAutosave() {
-    auto file = QFile(autosaveTextFile());
-    if(file.open(QIODevice::ReadOnly)) {
-        mDoc->setText(file.readAll());
-    }
-    file.close();
-    auto const lastConfig = mPresentation->configuration();
-    mPresentation->setConfig({autosaveJsonFile()});
-    auto transform = new TransformBoxUndo(mPresentation, lastConfig, mPresentation->configuration());
+    auto const state = AutosaveJournal::replay(autosaveJournalFile());
+    if(!state) {
+        mErrorOutput->setText(tr("Cannot recover autosave") + " \u26A0");
+        return;
+    }
+    mDoc->setText(state->text);
+    auto transform = new ConfigurationUndo(mPresentation, mPresentation->configuration(), state->configuration);
     mSlideWidget->undoStack().push(transform);
 }
 
 void MainWindow::deleteAutosave() {
-    QFile::remove(autosaveTextFile());
-    QFile::remove(autosaveJsonFile());
+    QFile::remove(autosaveJournalFile());
+}
+
+void MainWindow::startAutosave() {
+    mAutosaveJournal.open(autosaveJournalFile(), [this]{
+        return AutosaveState{mDoc->text(), mPresentation->configuration()};
+    });
 }
 
 void MainWindow::openFile() {
@@ -464,10 +477,12 @@ void MainWindow::openProject(QString path) {
     mIsModified = false;
     setWindowTitle(windowTitle());
     askToRecoverAutosave();
+    startAutosave();
 }
 
 void MainWindow::newDocument() {
     ui->mainWidget->setCurrentIndex(0);
+    mAutosaveJournal.close();
     mDoc = mEditor->createDocument(this);
     delete mViewTextDoc;
     mViewTextDoc = mDoc->createView(this);
@@ -479,6 +494,13 @@ void MainWindow::newDocument() {
         setWindowTitle(windowTitleNotSaved());
         mIsModified = true;
     }});
+    connect(mDoc, &KTextEditor::Document::textInserted,
+            this, [this](KTextEditor::Document*, KTextEditor::Cursor const& position, QString const& text){
+        mAutosaveJournal.appendTextInsert(position.line(), position.column(), text);});
+    connect(mDoc, &KTextEditor::Document::textRemoved,
+            this, [this](KTextEditor::Document*, KTextEditor::Range const& range, QString const&){
+        mAutosaveJournal.appendTextRemove(range.start().line(), range.start().column(),
+                                          range.end().line(), range.end().column());});
     setupFileActionsFromKPart();
     resetPresentation();
     mViewTextDoc->setFocus();
@@ -493,12 +515,8 @@ void MainWindow::newDocument() {
             this,[this](){mCursorTimer.start(10);});
     connect(&mCursorTimer, &QTimer::timeout,
             this, &MainWindow::updateCursorPosition);
-    connect(mPresentation.get(), &Presentation::slideChanged,
-            this, [this](int){mSlideWidget->update();
-            autosave();});
     setWindowTitle(windowTitle());
     mIsModified = false;
-    mLastAutosave = QDateTime::currentDateTime();
     fileChanged();
     resetCacheManager();
 }
@@ -507,8 +525,8 @@ bool MainWindow::save() {
     if(!mDoc->documentSave()) {
         return false;
     }
-    QFile::remove(autosaveTextFile());
     saveJson();
+    mAutosaveJournal.remove();
     ui->statusbar->showMessage(tr("Saved File to  \"%1\".").arg(mDoc->url().toLocalFile()), 10000);
     setWindowTitle(windowTitle());
     mIsModified = false;
@@ -519,8 +537,10 @@ bool MainWindow::saveAs(){
     if(!mDoc->documentSaveAs()) {
         return false;
     }
-    QFile::remove(autosaveTextFile());
     saveJson();
+    // the journal is named after the file
+    mAutosaveJournal.remove();
+    startAutosave();
     fileChanged();
     ui->statusbar->showMessage(tr("Saved File to  \"%1\".").arg(mDoc->url().toLocalFile()), 10000);
     setWindowTitle(windowTitle());
@@ -550,7 +570,7 @@ QString MainWindow::pathWithBaseName() const {
 
 
 QString MainWindow::jsonFileName() const {
-    return pathWithBaseName() + ".json";
+    return configFileName(pathWithBaseName());
 }
 
 QString MainWindow::fileDirectory() const {
@@ -565,12 +585,11 @@ QString MainWindow::workingDirectory() const {
 
 QString MainWindow::jsonFileName(QString textPath) const {
     auto const fileInfo = QFileInfo(textPath);
-    return fileInfo.path() + "/" + fileInfo.completeBaseName() + ".json";
+    return configFileName(fileInfo.path() + "/" + fileInfo.completeBaseName());
 }
 
 void MainWindow::saveJson() {
     mPresentation->configuration().saveConfig(jsonFileName());
-    QFile::remove(autosaveJsonFile());
 }
 
 void MainWindow::resetPresentation() {
@@ -579,6 +598,15 @@ void MainWindow::resetPresentation() {
     mSlideModel->setPresentation(mPresentation);
     connect(mPresentation.get(), &Presentation::rebuildNeeded,
             this, &MainWindow::fileChanged);
+    connect(mPresentation.get(), &Presentation::configurationChanged,
+            this, [this](QString const& boxId){
+        if(boxId.isEmpty()) {
+            mAutosaveJournal.appendConfiguration(mPresentation->configuration());
+        }
+        else {
+            mAutosaveJournal.appendGeometry(boxId, mPresentation->configuration().findRect(boxId));
+        }
+    });
 }
 
 void MainWindow::exportPDF() {
@@ -624,9 +652,60 @@ void MainWindow::exportPDFHandoutAs() {
     writePDFHandout();
 }
 
-void MainWindow::writePDF() const {
-    PDFCreator creator;
-    creator.createPdf(mPdfFile, mPresentation);
+void MainWindow::exportImages() {
+    auto const fileName = QFileDialog::getSaveFileName(this, tr("Export Images"),
+                                                       guessSavingDirectory() + "/slide.png",
+                                                       tr("PNG (*.png);;JPEG (*.jpg)"));
+    if(fileName.isEmpty()) {
+        return;
+    }
+    bool ok;
+    auto const dpi = QInputDialog::getInt(this, tr("Export Images"), tr("Resolution in dpi:"), 150, 10, 1200, 10, &ok);
+    if(!ok) {
+        return;
+    }
+    auto const fileInfo = QFileInfo(fileName);
+    ImageExportOptions options;
+    options.directory = fileInfo.absolutePath();
+    options.baseName = fileInfo.completeBaseName();
+    options.format = fileInfo.suffix() == "jpg" ? "jpg" : "png";
+    options.dpi = dpi;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    auto const result = ImageExporter().exportImages(*mPresentation, options);
+    QApplication::restoreOverrideCursor();
+    if(!result.success()) {
+        QMessageBox::information(this, tr("Cannot export images."), tr("Cannot write %1.").arg(result.failedFiles.join(", ")),
+                                 QMessageBox::Ok);
+        return;
+    }
+    ui->statusbar->showMessage(tr("Saved %1 images to \"%2\" (%3 images/s).").arg(result.images).arg(options.directory)
+                               .arg(result.imagesPerSecond(), 0, 'f', 1), 10000);
+}
+
+void MainWindow::setPdfImageResolution() {
+    QSettings settings;
+    bool ok;
+    auto const dpi = QInputDialog::getInt(this, tr("PDF Image Resolution"), tr("Maximal resolution of images in dpi, 0 keeps the files unchanged:"),
+                                          settings.value("pdfImageDpi", 0).toInt(), 0, 2400, 50, &ok);
+    if(!ok) {
+        return;
+    }
+    settings.setValue("pdfImageDpi", dpi);
+    mPdfCreator.setMaximalImageDpi(dpi);
+}
+
+void MainWindow::writePDF() {
+    // the pages of small presentations are written faster than the documents are merged
+    int numberPages = 0;
+    for(auto const& slide : mPresentation->data().slideListDefaultApplied().vector) {
+        numberPages += slide->numberPauses() + 1;
+    }
+    if(numberPages >= 32) {
+        mPdfCreator.createPdfParallel(mPdfFile, mPresentation);
+    }
+    else {
+        mPdfCreator.createPdf(mPdfFile, mPresentation);
+    }
     ui->statusbar->showMessage(tr("Saved PDF to \"%1\".").arg(mPdfFile), 10000);
 }
 
@@ -637,7 +716,7 @@ void MainWindow::writePDFHandout() const {
 }
 
 QString MainWindow::getConfigFilename(QUrl inputUrl) {
-    return completeBaseName() + ".json";
+    return QFileInfo(jsonFileName()).fileName();
 }
 
 QString MainWindow::getPdfFilename() {
@@ -708,54 +787,10 @@ bool MainWindow::closeDocument() {
       default:
         return false;
     }
-    QFile::remove(autosaveTextFile());
-    QFile::remove(autosaveJsonFile());
+    mAutosaveJournal.remove();
     return true;
 }
 
-Presentation::Ptr MainWindow::generateTemplatePresentation(QString directory) const {
-    QFile file(directory + "/demo.potato");
-    if (!file.open(QIODevice::ReadOnly)) {
-        return {};
-    }
-    auto const val = file.readAll();
-
-    auto presentation = std::make_shared<Presentation>();
-    presentation->setConfig({directory + "/demo.json"});
-
-    auto const parserOutput = generateSlides(val.toStdString(), directory);
-    if(parserOutput.successfull()) {
-        auto const slides = parserOutput.slideList();
-        auto const preamble = parserOutput.preamble();
-        auto templateName = preamble.templateName;
-        if (!QDir::isAbsolutePath(templateName)) {
-            templateName = directory + "/" + templateName;
-        }
-        auto const presentationTemplate = readTemplate(templateName);
-        try {
-            presentation->setData({slides, presentationTemplate});
-        }  catch (PorpertyConversionError) {
-            return {};
-        }
-        return presentation;
-    }
-    else {
-        return{};
-    }
-}
-
-Presentation::List MainWindow::generateTemplatePresentationList(std::vector<QString> directories) const {
-    Presentation::List list;
-    for(auto const& directory : directories) {
-        auto const presentation = generateTemplatePresentation(directory);
-        if (!presentation) {
-            continue;
-        }
-        list.push_back(presentation);
-    }
-    return list;
-}
-
 void MainWindow::insertTextInEditor(QString path) {
     QFile file(path + "/demo.potato");
     if (!file.open(QIODevice::ReadOnly)) {
@@ -877,39 +912,8 @@ void MainWindow::openCreatePresentationDialog() {
     ui->project_name_lineEdit->setFocus();
 }
 
-void MainWindow::autosave() {
-    // look up if the last autosave is more than 15s ago
-    auto const currentTime = QDateTime::currentDateTime();
-    if(mLastAutosave.addSecs(15) > currentTime) {
-        return;
-    }
-    mLastAutosave = currentTime;
-
-    // save txt file
-    QFile file(autosaveTextFile());
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return;
-    QTextStream out(&file);
-    out << mDoc->text();
-
-    // save json file
-    mPresentation->configuration().saveConfig(autosaveJsonFile());
-}
-
-QString MainWindow::autosaveTextFile(QString inputFile) const {
-    return inputFile + ".autosave";
-}
-
-QString MainWindow::autosaveTextFile() const {
-    return autosaveTextFile(absoluteFilePath());
-}
-
-QString MainWindow::autosaveJsonFile(QString jsonFile) const {
-    return jsonFile + ".autosave";
-}
-
-QString MainWindow::autosaveJsonFile() const {
-    return autosaveJsonFile(jsonFileName());
+QString MainWindow::autosaveJournalFile() const {
+    return absoluteFilePath() + ".journal";
 }
 
 void MainWindow::setActionenEnabled(bool enabled) {
@@ -918,6 +922,7 @@ void MainWindow::setActionenEnabled(bool enabled) {
     ui->actionExport_PDF_Handout->setEnabled(enabled);
     ui->actionExport_PDF_Handout_as->setEnabled(enabled);
     ui->actionExport_PDF_as->setEnabled(enabled);
+    ui->actionExport_Images->setEnabled(enabled);
     ui->actionRedo->setEnabled(enabled);
     ui->actionReload_Resources->setEnabled(enabled);
     ui->actionReset_Angle->setEnabled(enabled);
@@ -934,5 +939,35 @@ void MainWindow::resetCacheManager() {
     CacheManager<QPixmap>::instance().deleteAllResources();
     CacheManager<QSvgRenderer>::instance().deleteAllResources();
     CacheManager<PixMapVector>::instance().deleteAllResources();
+    CacheManager<ImageVector>::instance().deleteAllResources();
     cacheManager().resetCache();
+    displayListCache().clear();
+    mPdfCreator.resetExportCache();
+}
+
+void MainWindow::setTracingEnabled(bool enabled) {
+    tracer().setEnabled(enabled);
+    mTraceSummary->setVisible(enabled);
+    if(enabled) {
+        mTraceTimer.start(1000);
+    }
+    else {
+        mTraceTimer.stop();
+        mTraceSummary->clear();
+    }
+}
+
+void MainWindow::exportTrace() {
+    auto const fileName = QFileDialog::getSaveFileName(this, tr("Export Build Trace"),
+                                                       guessSavingDirectory() + "/trace.json",
+                                                       tr("Chrome trace (*.json)"));
+    if(fileName.isEmpty()) {
+        return;
+    }
+    if(!tracer().writeChromeTrace(fileName)) {
+        QMessageBox::information(this, tr("Cannot export trace."), tr("Cannot write %1.").arg(fileName),
+                                 QMessageBox::Ok);
+        return;
+    }
+    ui->statusbar->showMessage(tr("Saved build trace to \"%1\".").arg(fileName), 10000);
 }
@@ -28,6 +28,8 @@
 #include "templatelistmodel.h"
 #include "template.h"
 #include "templatecache.h"
+#include "autosavejournal.h"
+#include "pdfcreator.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -60,6 +62,8 @@ private:
     void exportPDFAs();
     void exportPDFHandout();
     void exportPDFHandoutAs();
+    void exportImages();
+    void setPdfImageResolution();
 
     // function to get the location of the file
     QFileInfo fileInfo() const;
@@ -78,7 +82,7 @@ private:
     // e.g. /home/project/test.h/test.h.potato -> /home/project
     QString workingDirectory() const;
 
-    void writePDF() const;
+    void writePDF();
     void writePDFHandout() const;
     QString getConfigFilename(QUrl inputUrl);
     QString getPdfFilename();
@@ -95,20 +99,15 @@ private:
     bool closeDocument();
     void closeEvent(QCloseEvent *event) override;
 
-    void autosave();
     void askToRecoverAutosave();
     void recoverAutosave();
     void deleteAutosave();
-    QString autosaveTextFile() const;
-    QString autosaveTextFile(QString inputFile) const;
-    QString autosaveJsonFile() const;
-    QString autosaveJsonFile(QString jsonFile) const;
+    void startAutosave();
+    QString autosaveJournalFile() const;
 
     void updateCursorPosition();
 
 //    start window
-    Presentation::Ptr generateTemplatePresentation(QString directory) const;
-    Presentation::List generateTemplatePresentationList(std::vector<QString> directories) const;
     void insertTextInEditor(QString path);
 
 //    open save project dialog
@@ -132,6 +131,10 @@ private:
 
     void resetCacheManager();
 
+    // build timings in the status bar
+    void setTracingEnabled(bool enabled);
+    void exportTrace();
+
 private:
     Ui::MainWindow *ui;
     KTextEditor::Editor* mEditor;
@@ -150,14 +153,18 @@ private:
 
     QString mPdfFile;
     QString mPdfFileHandout;
+    // keeps the pages of the last export to write only the changed pages again
+    PDFCreator mPdfCreator;
 
     QTimer mCursorTimer;
 
     QLabel* mErrorOutput;
     QToolButton* mCoupleButton;
     QToolButton* mSnappingButton;
+    QLabel* mTraceSummary;
+    QTimer mTraceTimer;
 
     bool mIsModified = false;
-    QDateTime mLastAutosave;
+    AutosaveJournal mAutosaveJournal;
 };
 #endif // MAINWINDOW_H
@@ -7,6 +7,7 @@
 #include "slidelistdelegate.h"
 #include "slide.h"
 #include "sliderenderer.h"
+#include "displaylistcache.h"
 #include "slidelistmodel.h"
 
 SlideListDelegate::SlideListDelegate(QObject *parent)
@@ -29,6 +30,7 @@ void SlideListDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opt
     painter->fillRect(slideRect, Qt::white);
     painter->setClipRect(slideRect);
     SlideRenderer paint{*painter};
+    paint.setDisplayListCache(&displayListCache());
     paint.paintSlide(slide);
     painter->restore();
 
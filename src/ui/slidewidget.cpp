@@ -14,30 +14,31 @@
 #include <QShortcut>
 #include <QMessageBox>
 #include "sliderenderer.h"
+#include "displaylistcache.h"
 #include "imagebox.h"
 #include "cachemanager.h"
 #include "transformboxundo.h"
+#include "tracing.h"
+#include <QElapsedTimer>
+#include <QScopedValueRollback>
+#include <algorithm>
+#include <map>
+#include <typeinfo>
+#include <unordered_set>
+
+auto constexpr slideTitleSpacing = 5;
 
 namespace {
-std::vector<int> boxesToXGuides(Box::List boxes) {
-    std::vector<int> guides;
-    for(auto const& box: boxes) {
-        guides.push_back(box->geometry().leftDisplay());
-    }
-    return guides;
+QString milliseconds(qint64 nanoseconds) {
+    return QString("%1 ms").arg(nanoseconds / 1e6, 0, 'f', 1);
 }
 
-std::vector<int> boxesToYGuides(Box::List boxes) {
-    std::vector<int> guides;
-    for(auto const& box: boxes) {
-        guides.push_back(box->geometry().topDisplay());
-    }
-    return guides;
+QString hitRate(QString const& name, CacheStatistics const& statistics) {
+    return QString("%1 %2% (%3/%4)").arg(name).arg(qRound(statistics.hitRate() * 100))
+            .arg(statistics.hits).arg(statistics.lookups());
 }
 }
 
-auto constexpr slideTitleSpacing = 5;
-
 SlideWidget::SlideWidget(QWidget*&)
     : QWidget(), mPageNumber{0}, mWidth{frameSize().width()}
 {
@@ -53,8 +54,11 @@ void SlideWidget::setPresentation(std::shared_ptr<Presentation> pres){
     mActiveBoxId = QString();
     mCurrentSlideId = QString();
     connect(mPresentation.get(), &Presentation::slideChanged,
-            this, QOverload<>::of(&SlideWidget::update));
+            this, &SlideWidget::onSlideChanged);
     mUndoStack.clear();
+    mRenderOutputs.clear();
+    mBoxIndex.reset();
+    invalidateStaticLayers();
     update();
 }
 
@@ -85,13 +89,124 @@ void SlideWidget::recalculateGeometry() {
 
 void SlideWidget::paintEvent(QPaintEvent*)
 {
+    QElapsedTimer paintTimer;
+    paintTimer.start();
     QPainter painter;
     painter.begin(this);
+
+    if (mPresentation->slideList().empty()) {
+        paintSurroundings(painter);
+        painter.save();
+        setSlideViewport(painter);
+        painter.fillRect(QRect(QPoint(0, 0), mSize), Qt::white);
+        painter.restore();
+        painter.end();
+        return;
+    }
+
+    auto const slide = mPresentation->data().slideListDefaultApplied().slideAt(mPageNumber);
+    mCurrentSlideId = slide->id();
+    auto const& box = mPresentation->findBox(mActiveBoxId);
+    if(box == nullptr || !slide->containsBox(mActiveBoxId)){
+        mActiveBoxId = QString();
+    }
+
+    mPaintTimes.clear();
+    auto const layered = !mActiveBoxId.isEmpty() && mStaticLayers.mPage == mPageNumber && mStaticLayers.mBoxId == mActiveBoxId;
+    if(layered) {
+        // only the manipulated box changes, everything else comes from the layers
+        painter.drawPixmap(0, 0, mStaticLayers.mBelow);
+    }
+    else {
+        paintSurroundings(painter);
+    }
+
     painter.save();
+    setSlideViewport(painter);
+    mGeometryDetail.mWidgetToSlideTransform = painter.combinedTransform().inverted();
+    if(!layered) {
+        painter.fillRect(QRect(QPoint(0, 0), mSize), Qt::white);
+    }
+    painter.setClipping(true);
+    painter.setClipRect(QRect(QPoint(0, 0), mSize));
+
+    SlideRenderer paint(painter);
+    paint.setRenderOutputs(&mRenderOutputs);
+    if(mPerformanceOverlay) {
+        paint.setPaintTimes(&mPaintTimes);
+    }
+    if(layered) {
+        paint.paintSlide(slide, slide->numberPauses(), [&box](Box::Ptr const& other){return other == box;});
+        painter.save();
+        painter.setViewTransformEnabled(false);
+        painter.resetTransform();
+        painter.setClipping(false);
+        painter.drawPixmap(0, 0, mStaticLayers.mAbove);
+        painter.restore();
+    }
+    else {
+        paint.setDisplayListCache(&displayListCache());
+        paint.paintSlide(slide);
+        // the painted areas of the boxes might have changed
+        mBoxIndex.reset();
+    }
+
+    // highlight the slowest box
+    auto const slowest = std::max_element(mPaintTimes.begin(), mPaintTimes.end(),
+                                          [](auto const& a, auto const& b){return a.nanoseconds < b.nanoseconds;});
+    if(slowest != mPaintTimes.end()) {
+        painter.save();
+        painter.setTransform(slowest->box->geometry().transform(), true);
+        QPen pen(Qt::red, 3, Qt::DashLine);
+        pen.setCosmetic(true);
+        painter.setPen(pen);
+        painter.drawRect(slowest->box->geometry().rect());
+        painter.restore();
+    }
+
+    // draw Guides for Snapping
+    if(mCurrentTrafo) {
+        painter.save();
+        painter.setPen("#999");
+        if(mCurrentTrafo->snapToMiddle()) {
+            auto const textRect = snapToMiddleTextRect();
+            painter.fillRect(textRect, "#ddd");
+            painter.setPen(Qt::black);
+            painter.setFont(QFont("sans-serif", 10));
+            painter.drawText(textRect, "Snap to middle");
+            painter.setPen("#777");
+        }
+        if(mCurrentTrafo->xGuide()) {
+            auto const x = mCurrentTrafo->xGuide().value();
+            painter.drawLine(x, 0, x, mSize.height());
+        }
+        if(mCurrentTrafo->yGuide()) {
+            auto const y = mCurrentTrafo->yGuide().value();
+            painter.drawLine(0, y, mSize.width(), y);
+        }
+        painter.restore();
+    }
 
+    if(!mActiveBoxId.isEmpty()){
+        box->drawManipulationSlide(painter, mDiffToMouse);
+    }
+    painter.restore();
+
+    if(!layered) {
+        paintSlideTitle(painter, slide);
+    }
+
+    if(mPerformanceOverlay) {
+        paintPerformanceOverlay(painter, paintTimer.nsecsElapsed());
+    }
+    painter.end();
+}
+
+void SlideWidget::paintSurroundings(QPainter& painter) const {
     auto const marginLeft = mGeometryDetail.mTopLeft;
     auto const innerSize = mGeometryDetail.mSlideSize;
 
+    painter.save();
     // Draw drop shadow
     QPoint const shadowOffset = {3, 3};
     auto const shadowBasePos = marginLeft + shadowOffset;
@@ -113,68 +228,190 @@ void SlideWidget::paintEvent(QPaintEvent*)
     grownSize.rwidth() += 1;
     grownSize.rheight() += 1;
     painter.drawRect(QRect(marginLeft - QPoint(1, 1), grownSize));
+    painter.restore();
+}
 
-    // Done drawing the surroundings -- draw slide content now
-    painter.setViewport(QRect(marginLeft, innerSize));
+void SlideWidget::setSlideViewport(QPainter& painter) const {
+    painter.setViewport(QRect(mGeometryDetail.mTopLeft, mGeometryDetail.mSlideSize));
     painter.setWindow(QRect({0, 0}, mSize));
-
-    mGeometryDetail.mWidgetToSlideTransform = painter.combinedTransform().inverted();
-
     painter.setRenderHint(QPainter::SmoothPixmapTransform);
-    painter.fillRect(QRect(QPoint(0, 0), mSize), Qt::white);
+}
 
-    if (mPresentation->slideList().empty()) {
-        painter.restore();
-        painter.end();
+void SlideWidget::paintSlideTitle(QPainter& painter, Slide::Ptr const& slide) const {
+    painter.save();
+    painter.setFont(mTitleFont);
+    auto const slideTitleRect = QRect(rect().translated(0, mGeometryDetail.mSlideSize.height() + mGeometryDetail.mTopLeft.y() + slideTitleSpacing));
+    painter.drawText(slideTitleRect, slide->id(), QTextOption(Qt::AlignHCenter | Qt::AlignTop));
+    painter.restore();
+}
+
+void SlideWidget::buildStaticLayers() {
+    auto const slide = mPresentation->data().slideListDefaultApplied().slideAt(mPageNumber);
+    auto const activeBox = mPresentation->findBox(mActiveBoxId);
+    auto const& boxes = slide->boxes();
+    auto const active = std::find(boxes.begin(), boxes.end(), activeBox);
+    if(active == boxes.end()) {
+        invalidateStaticLayers();
         return;
     }
+    std::unordered_set<Box const*> const above = [&]{
+        std::unordered_set<Box const*> above;
+        for(auto it = active + 1; it != boxes.end(); ++it) {
+            above.insert(it->get());
+        }
+        return above;
+    }();
+    auto const newLayer = [this]{
+        QPixmap layer(size() * devicePixelRatioF());
+        layer.setDevicePixelRatio(devicePixelRatioF());
+        layer.fill(Qt::transparent);
+        return layer;
+    };
+
+    // surroundings, slide background and every box below the active one
+    mStaticLayers.mBelow = newLayer();
+    QPainter painter(&mStaticLayers.mBelow);
+    paintSurroundings(painter);
+    painter.save();
+    setSlideViewport(painter);
+    painter.fillRect(QRect(QPoint(0, 0), mSize), Qt::white);
+    painter.setClipRect(QRect(QPoint(0, 0), mSize));
+    SlideRenderer belowRenderer(painter);
+    belowRenderer.setRenderOutputs(&mRenderOutputs);
+    belowRenderer.paintSlide(slide, slide->numberPauses(), [&](Box::Ptr const& box){
+        return box != activeBox && !above.contains(box.get());
+    });
+    painter.restore();
+    paintSlideTitle(painter, slide);
+    painter.end();
 
-    painter.setClipping(true);
+    // boxes above the active one on a transparent background
+    mStaticLayers.mAbove = newLayer();
+    painter.begin(&mStaticLayers.mAbove);
+    setSlideViewport(painter);
     painter.setClipRect(QRect(QPoint(0, 0), mSize));
+    SlideRenderer aboveRenderer(painter);
+    aboveRenderer.setRenderOutputs(&mRenderOutputs);
+    aboveRenderer.paintSlide(slide, slide->numberPauses(), [&above](Box::Ptr const& box){
+        return above.contains(box.get());
+    });
+    painter.end();
 
-    SlideRenderer paint(painter);
-    auto const slide = mPresentation->data().slideListDefaultApplied().slideAt(mPageNumber);
-    paint.paintSlide(slide);
-    mCurrentSlideId = slide->id();
+    mStaticLayers.mPage = mPageNumber;
+    mStaticLayers.mBoxId = mActiveBoxId;
+}
 
-    // draw Guides for Snapping
+void SlideWidget::invalidateStaticLayers() {
+    mStaticLayers = {};
+}
+
+QRect SlideWidget::snapToMiddleTextRect() const {
+    return QRect(mSize.width() / 2, 20, 140, 20);
+}
+
+QRegion SlideWidget::manipulationRegion() const {
+    auto const slideToWidget = mGeometryDetail.mWidgetToSlideTransform.inverted();
+    auto const toWidget = [&slideToWidget](QPolygonF const& polygon) {
+        // antialiased and cosmetic lines can reach into the neighbouring pixels
+        return slideToWidget.map(polygon).boundingRect().toAlignedRect().adjusted(-2, -2, 2, 2);
+    };
+    QRegion region;
+    auto const box = mPresentation->findBox(mActiveBoxId);
+    if(box) {
+        // the manipulation frame is drawn up to mDiffToMouse outside of the box
+        auto const rect = QRectF(box->paintedRect(renderOutput(box->id())).marginsAdded({mDiffToMouse, mDiffToMouse, mDiffToMouse, mDiffToMouse}));
+        region += toWidget(box->geometry().transform().map(QPolygonF(rect)));
+    }
     if(mCurrentTrafo) {
-        painter.save();
-        painter.setPen("#999");
         if(mCurrentTrafo->snapToMiddle()) {
-            auto const textRect = QRect(mSize.width() / 2, 20, 140, 20);
-            painter.fillRect(textRect, "#ddd");
-            painter.setPen(Qt::black);
-            painter.setFont(QFont("sans-serif", 10));
-            painter.drawText(textRect, "Snap to middle");
-            painter.setPen("#777");
+            region += toWidget(QPolygonF(QRectF(snapToMiddleTextRect())));
         }
         if(mCurrentTrafo->xGuide()) {
             auto const x = mCurrentTrafo->xGuide().value();
-            painter.drawLine(x, 0, x, mSize.height());
+            region += toWidget(QPolygonF(QRectF(x, 0, 0, mSize.height())));
         }
         if(mCurrentTrafo->yGuide()) {
             auto const y = mCurrentTrafo->yGuide().value();
-            painter.drawLine(0, y, mSize.width(), y);
+            region += toWidget(QPolygonF(QRectF(0, y, mSize.width(), 0)));
         }
-        painter.restore();
     }
+    if(mPerformanceOverlay) {
+        region += mOverlayRect;
+    }
+    return region;
+}
 
-    auto const& box = mPresentation->findBox(mActiveBoxId);
-    if(box != nullptr && slide->containsBox(mActiveBoxId)){
-        box->drawManipulationSlide(painter, mDiffToMouse);
+void SlideWidget::onSlideChanged(int first, int last) {
+    mBoxIndex.reset();
+    // the geometry changes of the manipulated box are repainted by its dirty region
+    if(mManipulating && first == mPageNumber && last == mPageNumber) {
+        return;
     }
-    else{
-        mActiveBoxId = QString();
+    invalidateStaticLayers();
+    update();
+}
+
+void SlideWidget::setManipulatedBoxGeometry(BoxGeometry const& geometry) {
+    auto const dirtyBefore = manipulationRegion();
+    {
+        QScopedValueRollback manipulating(mManipulating, true);
+        mPresentation->setBoxGeometry(mActiveBoxId, geometry, mPageNumber);
     }
+    update(dirtyBefore + manipulationRegion());
+}
+
+void SlideWidget::paintPerformanceOverlay(QPainter& painter, qint64 paintNanoseconds) {
+    QStringList lines;
+    lines.append("paint " + milliseconds(paintNanoseconds));
 
-    // draw slide title
+    // draw time per box type, the slowest type first
+    std::map<QString, std::pair<qint64, int>> types;
+    for(auto const& time : mPaintTimes) {
+        auto& type = types[readableSpanName(typeid(*time.box).name())];
+        type.first += time.nanoseconds;
+        type.second++;
+    }
+    std::vector<std::pair<QString, std::pair<qint64, int>>> sortedTypes(types.begin(), types.end());
+    std::sort(sortedTypes.begin(), sortedTypes.end(), [](auto const& a, auto const& b){return a.second.first > b.second.first;});
+    for(auto const& [type, time] : sortedTypes) {
+        lines.append(QString("%1 x%2: %3").arg(type).arg(time.second).arg(milliseconds(time.first)));
+    }
+    auto const slowest = std::max_element(mPaintTimes.begin(), mPaintTimes.end(),
+                                          [](auto const& a, auto const& b){return a.nanoseconds < b.nanoseconds;});
+    if(slowest != mPaintTimes.end()) {
+        lines.append(QString("slowest: %1 %2 (line %3)").arg(slowest->box->id(), milliseconds(slowest->nanoseconds))
+                     .arg(slowest->box->line() + 1));
+    }
+
+    lines.append(hitRate("image cache", CacheManager<PixMapVector>::instance().statistics()) + "  "
+                 + hitRate("LaTeX cache", cacheManager().statistics()));
+    lines.append(hitRate("display lists", displayListCache().statistics()));
+    lines.append(QString("pending LaTeX jobs %1").arg(cacheManager().numberOfPendingJobs()));
+    lines.append("parse " + milliseconds(mParseTime) + "  apply " + milliseconds(mApplyTime));
+
+    painter.save();
+    QFont font("monospace");
+    font.setStyleHint(QFont::Monospace);
+    font.setPixelSize(12);
+    painter.setFont(font);
+    auto const text = lines.join('\n');
+    auto const textRect = painter.fontMetrics().boundingRect(QRect(0, 0, width(), height()), Qt::AlignLeft | Qt::AlignTop, text);
+    auto const background = textRect.marginsAdded({6, 4, 6, 4}).translated(mGeometryDetail.mTopLeft + QPoint(10, 10));
+    painter.fillRect(background, QColor(0, 0, 0, 180));
+    mOverlayRect = background;
+    painter.setPen(Qt::white);
+    painter.drawText(background.marginsRemoved({6, 4, 6, 4}), Qt::AlignLeft | Qt::AlignTop, text);
     painter.restore();
-    painter.setFont(mTitleFont);
-    auto const slideTitleRect = QRect(rect().translated(0, innerSize.height() + marginLeft.y() + slideTitleSpacing));
-    painter.drawText(slideTitleRect, slide->id(), QTextOption(Qt::AlignHCenter | Qt::AlignTop));
+}
 
-    painter.end();
+void SlideWidget::setPerformanceOverlay(bool enabled) {
+    mPerformanceOverlay = enabled;
+    update();
+}
+
+void SlideWidget::setBuildDurations(qint64 parseNanoseconds, qint64 applyNanoseconds) {
+    mParseTime = parseNanoseconds;
+    mApplyTime = applyNanoseconds;
 }
 
 void SlideWidget::contextMenuEvent(QContextMenuEvent *event){
@@ -185,7 +422,7 @@ void SlideWidget::contextMenuEvent(QContextMenuEvent *event){
     menu.addAction(mResetAngle);
     auto const image = std::dynamic_pointer_cast<ImageBox>(mPresentation->findBox(mActiveBoxId));
     if(image){
-        auto const imagePath = absoluteImagePath(image->ImagePath());
+        auto const imagePath = absoluteImagePath(image->ImagePath(currentContext()));
         if(QFile::exists(imagePath)){
             menu.addAction(mOpenInkscape);
         }
@@ -197,6 +434,8 @@ void SlideWidget::contextMenuEvent(QContextMenuEvent *event){
 }
 
 void SlideWidget::updateSlides(){
+    mBoxIndex.reset();
+    invalidateStaticLayers();
     setCurrentPage(mCurrentSlideId);
     if(mPageNumber >= int(mPresentation->slideList().vector.size())) {
         mPageNumber = int(mPresentation->slideList().vector.size()) - 1;
@@ -206,6 +445,8 @@ void SlideWidget::updateSlides(){
 }
 
 void SlideWidget::updateSlideId() {
+    mBoxIndex.reset();
+    invalidateStaticLayers();
     if(mPresentation->slideList().vector.empty()) {
         mCurrentSlideId = "";
         return;
@@ -223,6 +464,9 @@ void SlideWidget::setCurrentPage(int page){
     mPageNumber = page;
     mCurrentSlideId = mPresentation->slideList().slideAt(page)->id();
     mActiveBoxId = QString();
+    mRenderOutputs.clear();
+    mBoxIndex.reset();
+    invalidateStaticLayers();
     Q_EMIT selectionChanged(mPresentation->slideList().slideAt(mPageNumber));
     update();
 }
@@ -241,6 +485,25 @@ void SlideWidget::setCurrentPage(QString slideId){
 void SlideWidget::resizeEvent(QResizeEvent*) {
     mWidth = frameSize().width();
     recalculateGeometry();
+    invalidateStaticLayers();
+}
+
+void SlideWidget::focusInEvent(QFocusEvent* event) {
+    // the focus frame is part of the static layers
+    invalidateStaticLayers();
+    QWidget::focusInEvent(event);
+}
+
+void SlideWidget::focusOutEvent(QFocusEvent* event) {
+    invalidateStaticLayers();
+    QWidget::focusOutEvent(event);
+}
+
+void SlideWidget::invalidate() {
+    // the painted area of a box can change, e.g. after its image got loaded
+    mBoxIndex.reset();
+    invalidateStaticLayers();
+    update();
 }
 
 void SlideWidget::determineBoxInFocus(QPoint mousePos){
@@ -268,9 +531,10 @@ void SlideWidget::determineBoxInFocus(QPoint mousePos){
 
 std::vector<QString> SlideWidget::determineVisibleBoxesUnderMouse(QPoint mousePos){
     std::vector<QString> boxesUnderMouse;
-    for(auto &box: mPresentation->slideList().slideAt(mPageNumber)->boxes()) {
-        if(box->containsPoint(mousePos, mDiffToMouse)) {
-            boxesUnderMouse.push_back(box->id());
+    auto const& boxes = mPresentation->slideList().slideAt(mPageNumber)->boxes();
+    for(auto const index: boxIndex().candidates(mousePos)) {
+        if(boxes[index]->containsPoint(mousePos, mDiffToMouse, renderOutput(boxes[index]->id()))) {
+            boxesUnderMouse.push_back(boxes[index]->id());
         }
     }
     return boxesUnderMouse;
@@ -278,14 +542,32 @@ std::vector<QString> SlideWidget::determineVisibleBoxesUnderMouse(QPoint mousePo
 
 std::vector<QString> SlideWidget::determineBoxesUnderMouse(QPoint mousePos){
     std::vector<QString> boxesUnderMouse;
-    for(auto &box: mPresentation->slideList().slideAt(mPageNumber)->boxes()) {
-        if(box->geometry().contains(mousePos, mDiffToMouse)) {
-            boxesUnderMouse.push_back(box->id());
+    auto const& boxes = mPresentation->slideList().slideAt(mPageNumber)->boxes();
+    for(auto const index: boxIndex().candidates(mousePos)) {
+        if(boxes[index]->geometry().contains(mousePos, mDiffToMouse)) {
+            boxesUnderMouse.push_back(boxes[index]->id());
         }
     }
     return boxesUnderMouse;
 }
 
+BoxRenderOutput const& SlideWidget::renderOutput(QString const& boxId) const {
+    static BoxRenderOutput const notPainted;
+    auto const output = mRenderOutputs.find(boxId);
+    return output == mRenderOutputs.end() ? notPainted : output->second;
+}
+
+PresentationContext const& SlideWidget::currentContext() const {
+    return mPresentation->data().slideListDefaultApplied().slideAt(mPageNumber)->context();
+}
+
+BoxIndex const& SlideWidget::boxIndex() {
+    if(!mBoxIndex) {
+        mBoxIndex.emplace(mPresentation->slideList().slideAt(mPageNumber)->boxes(), mRenderOutputs, mSize, mDiffToMouse);
+    }
+    return *mBoxIndex;
+}
+
 void SlideWidget::mousePressEvent(QMouseEvent *event)
 {
     if(mPresentation->slideList().empty()){
@@ -297,7 +579,6 @@ void SlideWidget::mousePressEvent(QMouseEvent *event)
     }
     mCursorLastPosition = ScaledMousePos(event);
     cursorApperance(mCursorLastPosition);
-    mLastConfigFile = mPresentation->configuration();    
     update();
 }
 
@@ -326,21 +607,20 @@ void SlideWidget::mouseMoveEvent(QMouseEvent *event)
             mActiveBoxId = QString();
             return;
         }
+        mGeometryBeforeTransformation = mPresentation->boxGeometryState(mActiveBoxId);
         mCurrentTrafo = BoxTransformation(boxInFocus->geometry(), mTransform, classifiedMousePos, newPosition);
         if(mSnapping) {
-            auto boxesWithoutActive = mPresentation->slideList().vector[mPageNumber]->boxes();
-            std::erase_if(boxesWithoutActive, [this](auto a){return a->id() == mActiveBoxId;});
-            auto xSnapGuides = boxesToXGuides(boxesWithoutActive);
-            xSnapGuides.push_back(0);
-            xSnapGuides.push_back(mSize.width());
-            auto ySnapGuides = boxesToYGuides(boxesWithoutActive);
-            ySnapGuides.push_back(0);
-            ySnapGuides.push_back(mSize.height());
-            mCurrentTrafo->setSnapping({xSnapGuides, ySnapGuides, {mSize.width() / 2}, mDiffToMouse});
+            // boxes of the template, e.g. title and body, are guides, too
+            auto guideBoxes = mPresentation->data().slideListDefaultApplied().slideAt(mPageNumber)->templateBoxes();
+            auto const& boxes = mPresentation->slideList().slideAt(mPageNumber)->boxes();
+            std::copy_if(boxes.begin(), boxes.end(), std::back_inserter(guideBoxes), [this](auto const& box){return box->id() != mActiveBoxId;});
+            mCurrentTrafo->setSnapping({guideBoxes, boxInFocus->geometry().rect(), mSize, mDiffToMouse});
+        }
+        if(mStaticLayers.mPage != mPageNumber || mStaticLayers.mBoxId != mActiveBoxId) {
+            buildStaticLayers();
         }
     }
-    auto transformedRect = mCurrentTrafo->doTransformation(newPosition);
-    mPresentation->setBoxGeometry(mActiveBoxId, transformedRect, mPageNumber);
+    setManipulatedBoxGeometry(mCurrentTrafo->doTransformation(newPosition));
     mCursorLastPosition = newPosition;
 }
 
@@ -360,7 +640,10 @@ void SlideWidget::mouseReleaseEvent(QMouseEvent *event)
         }
     }
     else {
-        auto transform = new TransformBoxUndo(mPresentation, mLastConfigFile, mPresentation->configuration());
+        auto transform = new TransformBoxUndo(mPresentation, mActiveBoxId, mPageNumber,
+                                              mGeometryBeforeTransformation, mPresentation->boxGeometryState(mActiveBoxId));
+        // pushing redoes the transformation that is already shown
+        QScopedValueRollback manipulating(mManipulating, true);
         mUndoStack.push(transform);
     }
     mCurrentTrafo.reset();
@@ -389,13 +672,25 @@ void SlideWidget::keyPressEvent(QKeyEvent *event) {
         mActiveBoxId = "";
         update();
         return;
+        default:
+        QWidget::keyPressEvent(event);
+        return;
     }
 
+    if(mStaticLayers.mPage != mPageNumber || mStaticLayers.mBoxId != mActiveBoxId) {
+        buildStaticLayers();
+    }
+    auto const stateBefore = mPresentation->boxGeometryState(mActiveBoxId);
     auto geometry = mPresentation->findBox(mActiveBoxId)->geometry();
     auto rect = geometry.rect();
     rect.translate(translation * 2);
     geometry.setRect(rect);
-    mPresentation->setBoxGeometry(mActiveBoxId, geometry, mPageNumber);
+    setManipulatedBoxGeometry(geometry);
+    // consecutive key presses on the same box are merged into one undo step
+    auto transform = new TransformBoxUndo(mPresentation, mActiveBoxId, mPageNumber,
+                                          stateBefore, mPresentation->boxGeometryState(mActiveBoxId), true);
+    QScopedValueRollback manipulating(mManipulating, true);
+    mUndoStack.push(transform);
 }
 
 
@@ -474,9 +769,10 @@ void SlideWidget::deleteBoxPosition() {
     if(mActiveBoxId.isEmpty()) {
         return;
     }
-    auto const lastConfig = mPresentation->configuration();
+    auto const stateBefore = mPresentation->boxGeometryState(mActiveBoxId);
     mPresentation->deleteBoxGeometry(mActiveBoxId, mPageNumber);
-    auto transform = new TransformBoxUndo(mPresentation, lastConfig, mPresentation->configuration());
+    auto transform = new TransformBoxUndo(mPresentation, mActiveBoxId, mPageNumber,
+                                          stateBefore, mPresentation->boxGeometryState(mActiveBoxId));
     mUndoStack.push(transform);
 }
 
@@ -484,9 +780,10 @@ void SlideWidget::deleteBoxAngle() {
     if(mActiveBoxId.isEmpty()) {
         return;
     }
-    auto const lastConfig = mPresentation->configuration();
+    auto const stateBefore = mPresentation->boxGeometryState(mActiveBoxId);
     mPresentation->deleteBoxAngle(mActiveBoxId, mPageNumber);
-    auto transform = new TransformBoxUndo(mPresentation, lastConfig, mPresentation->configuration());
+    auto transform = new TransformBoxUndo(mPresentation, mActiveBoxId, mPageNumber,
+                                          stateBefore, mPresentation->boxGeometryState(mActiveBoxId));
     mUndoStack.push(transform);
 }
 
@@ -569,7 +866,7 @@ void SlideWidget::openInInkscape(){
     }
     QString program = "/usr/bin/inkscape";
     QStringList arguments;
-    arguments << absoluteImagePath(image->ImagePath());
+    arguments << absoluteImagePath(image->ImagePath(currentContext()));
     QProcess *inkscapeProcess = new QProcess(this);
     auto success = inkscapeProcess->startDetached(program, arguments);
     if(!success) {
@@ -583,16 +880,17 @@ void SlideWidget::createAndOpenSvg(){
     if(!image){
         return;
     }
-    QDir().mkpath(QFileInfo(image->ImagePath()).absolutePath());
-    CacheManager<QSvgRenderer>::instance().deleteFile(image->ImagePath());
+    auto const imagePath = image->ImagePath(currentContext());
+    QDir().mkpath(QFileInfo(imagePath).absolutePath());
+    CacheManager<QSvgRenderer>::instance().deleteFile(imagePath);
     QSvgGenerator generator;
-    generator.setFileName(absoluteImagePath(image->ImagePath()));
+    generator.setFileName(absoluteImagePath(imagePath));
     generator.setSize(image->geometry().rect().size());
     generator.setViewBox(QRect(QPoint(0, 0), image->geometry().rect().size()));
     QPainter painter;
     painter.begin(&generator);
     painter.end();
-    update();
+    invalidate();
     openInInkscape();
 }
 
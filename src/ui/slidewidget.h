@@ -9,6 +9,7 @@
 
 #include <QWidget>
 #include <QSize>
+#include <QPixmap>
 #include <QPdfWriter>
 #include <QPrinter>
 #include <QDebug>
@@ -22,6 +23,8 @@
 #include "boxgeometry.h"
 #include "boxtransformation.h"
 #include "snapping.h"
+#include "sliderenderer.h"
+#include "boxindex.h"
 
 class SlideWidget : public QWidget
 {
@@ -46,12 +49,20 @@ public:
 
     void setSnapping(bool snapping);
 
+    // overlay with the paint times of the boxes, the cache hit rates and the build durations
+    void setPerformanceOverlay(bool enabled);
+    // durations of the last build shown in the overlay
+    void setBuildDurations(qint64 parseNanoseconds, qint64 applyNanoseconds);
+
     // set the active Box on the position of a tool bar button
     void deleteBoxPosition();
     void deleteBoxAngle();
 
     void setActiveBox(QString boxId, QString slideId);
 
+    // repaints everything, e.g. after an image or a LaTeX formula got loaded
+    void invalidate();
+
     // trigger undo / redo actions
     void undo();
     void redo();
@@ -67,6 +78,8 @@ private:
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
+    void focusInEvent(QFocusEvent *event) override;
+    void focusOutEvent(QFocusEvent *event) override;
 
     void recalculateGeometry();
 
@@ -82,6 +95,11 @@ private:
     std::vector<QString> determineVisibleBoxesUnderMouse(QPoint mousePos);
     std::vector<QString> determineBoxesUnderMouse(QPoint mousePos);
     void determineBoxInFocus(QPoint mousePos);
+    // index of the boxes of the current page, built on the first hit test after a change
+    BoxIndex const& boxIndex();
+    // output of the last paint of the box, empty if it was not painted
+    BoxRenderOutput const& renderOutput(QString const& boxId) const;
+    PresentationContext const& currentContext() const;
 
     // actions in Context Menu
     void createActions();
@@ -90,6 +108,22 @@ private:
 
     QString absoluteImagePath(QString imagePath) const;
 
+    void paintPerformanceOverlay(QPainter& painter, qint64 paintNanoseconds);
+
+    void paintSurroundings(QPainter& painter) const;
+    void setSlideViewport(QPainter& painter) const;
+    void paintSlideTitle(QPainter& painter, Slide::Ptr const& slide) const;
+    QRect snapToMiddleTextRect() const;
+
+    // While a box is moved only the area around it gets repainted. Everything below and
+    // above the active box is cached in two layers, so that only the active box is drawn.
+    void buildStaticLayers();
+    void invalidateStaticLayers();
+    // widget area of the active box, its manipulation frame, the snap guides and the overlay
+    QRegion manipulationRegion() const;
+    void setManipulatedBoxGeometry(BoxGeometry const& geometry);
+    void onSlideChanged(int first, int last);
+
 private:
     std::shared_ptr<Presentation> mPresentation;
     QString mActiveBoxId;
@@ -123,9 +157,30 @@ private:
     QAction* mResetAngle;
 
     QUndoStack mUndoStack;
-    ConfigBoxes mLastConfigFile;
+    BoxGeometryState mGeometryBeforeTransformation;
 
     bool mSnapping = true;
+
+    std::optional<BoxIndex> mBoxIndex;
+    // outputs of the boxes of the current page painted last
+    BoxRenderOutputs mRenderOutputs;
+
+    struct {
+        // surroundings, slide and boxes below the active box
+        QPixmap mBelow;
+        // boxes above the active box
+        QPixmap mAbove;
+        int mPage = -1;
+        QString mBoxId;
+    } mStaticLayers;
+    // set while the widget changes the geometry of the active box itself
+    bool mManipulating = false;
+
+    bool mPerformanceOverlay = false;
+    QRect mOverlayRect;
+    std::vector<BoxPaintTime> mPaintTimes;
+    qint64 mParseTime = 0;
+    qint64 mApplyTime = 0;
 };
 
 #endif // PAINTDOCUMENT_H
@@ -5,13 +5,73 @@
 */
 
 #include "snapping.h"
+#include <algorithm>
+#include <iterator>
 
-Snapping::Snapping(std::vector<int> xGuides, std::vector<int> yGuides, std::vector<int> yMiddleGuides, int margin)
-    : mXSnap(xGuides)
-    , mYSnap(yGuides)
-    , mYSnapMiddle(yMiddleGuides)
+namespace {
+struct Interval {
+    int begin;
+    int end;
+};
+
+void sortAndUnique(std::vector<int>& guides) {
+    std::sort(guides.begin(), guides.end());
+    guides.erase(std::unique(guides.begin(), guides.end()), guides.end());
+}
+
+bool overlap(Interval a, Interval b) {
+    return a.begin < b.end && b.begin < a.end;
+}
+
+// Positions of the begin of an interval of the given size which has the same distance
+// to two intervals as they have to each other, or the same distance to both.
+// Only pairs which overlap with the moving interval in the other direction, e.g. boxes in
+// the same row as the moving box, are considered.
+std::vector<int> spacingGuides(std::vector<std::pair<Interval, Interval>> const& intervals, int size, Interval movingOther) {
+    std::vector<std::pair<Interval, Interval>> inLine;
+    std::copy_if(intervals.begin(), intervals.end(), std::back_inserter(inLine),
+                 [movingOther](auto const& interval){return overlap(interval.second, movingOther);});
+    std::vector<int> guides;
+    for(auto const& [a, aOther] : inLine) {
+        for(auto const& [b, bOther] : inLine) {
+            if(a.end >= b.begin) {
+                continue;
+            }
+            auto const gap = b.begin - a.end;
+            guides.push_back(b.end + gap);
+            guides.push_back(a.begin - gap - size);
+            if(gap > size) {
+                guides.push_back(a.end + (gap - size) / 2);
+            }
+        }
+    }
+    sortAndUnique(guides);
+    return guides;
+}
+}
+
+Snapping::Snapping(Box::List const& boxes, QRect movingRect, QSize slideSize, int margin)
+    : mXSnap{0, slideSize.width()}
+    , mYSnap{0, slideSize.height()}
+    , mYSnapMiddle{slideSize.width() / 2}
     , mMargin(margin)
 {
+    std::vector<std::pair<Interval, Interval>> xIntervals, yIntervals;
+    for(auto const& box : boxes) {
+        auto const& geometry = box->geometry();
+        auto const x = Interval{geometry.leftDisplay(), geometry.leftDisplay() + geometry.widthDisplay()};
+        auto const y = Interval{geometry.topDisplay(), geometry.topDisplay() + geometry.heightDisplay()};
+        mXSnap.insert(mXSnap.end(), {x.begin, (x.begin + x.end) / 2, x.end});
+        mYSnap.insert(mYSnap.end(), {y.begin, (y.begin + y.end) / 2, y.end});
+        xIntervals.push_back({x, y});
+        yIntervals.push_back({y, x});
+    }
+    sortAndUnique(mXSnap);
+    sortAndUnique(mYSnap);
+    auto const movingX = Interval{movingRect.left(), movingRect.left() + movingRect.width()};
+    auto const movingY = Interval{movingRect.top(), movingRect.top() + movingRect.height()};
+    mXSpacing = spacingGuides(xIntervals, movingRect.width(), movingY);
+    mYSpacing = spacingGuides(yIntervals, movingRect.height(), movingX);
 }
 
 std::optional<int> Snapping::snapX(int position) const {
@@ -26,18 +86,45 @@ std::optional<int> Snapping::snapYMiddle(int position) const {
     return fittingSnapObjects(position, mYSnapMiddle);
 }
 
-std::optional<int> Snapping::fittingSnapObjects(int position, std::vector<int> possibleSnappings) const {
-    std::vector<int> snappingVector;
-    for(auto const possibleSnapping: possibleSnappings) {
-        if(possibleSnapping - mMargin < position && possibleSnapping + mMargin > position) {
-            snappingVector.push_back(possibleSnapping);
+std::optional<Snapping::Snap> Snapping::snapRectX(QRect rect) const {
+    return snapRect(rect.left(), rect.width(), mXSnap, mXSpacing);
+}
+
+std::optional<Snapping::Snap> Snapping::snapRectY(QRect rect) const {
+    return snapRect(rect.top(), rect.height(), mYSnap, mYSpacing);
+}
+
+std::optional<Snapping::Snap> Snapping::snapRect(int begin, int size, std::vector<int> const& guides, std::vector<int> const& spacings) const {
+    std::optional<Snap> best;
+    auto const consider = [&best](std::optional<int> guide, int position) {
+        if(guide && (!best || std::abs(*guide - position) < std::abs(best->offset))) {
+            best = Snap{*guide - position, *guide};
         }
+    };
+    for(auto const position : {begin, begin + size / 2, begin + size}) {
+        consider(fittingSnapObjects(position, guides), position);
     }
-    if(snappingVector.empty()) {
+    // the guide of equal spacing is shown at the snapped edge
+    consider(fittingSnapObjects(begin, spacings), begin);
+    return best;
+}
+
+void Snapping::setMargin(int margin) {
+    mMargin = margin;
+}
+
+std::optional<int> Snapping::fittingSnapObjects(int position, std::vector<int> const& possibleSnappings) const {
+    // the closest guide is either the first one not less than position or the one before
+    auto const next = std::lower_bound(possibleSnappings.begin(), possibleSnappings.end(), position);
+    std::optional<int> closest;
+    if(next != possibleSnappings.end()) {
+        closest = *next;
+    }
+    if(next != possibleSnappings.begin() && (!closest || position - *(next - 1) < *closest - position)) {
+        closest = *(next - 1);
+    }
+    if(!closest || std::abs(*closest - position) >= mMargin) {
         return {};
     }
-    auto const compare = [position](auto a, auto b){
-        return std::abs(a - position) < std::abs(b - position);
-    };
-    return *std::min_element(snappingVector.begin(), snappingVector.end(), compare);
+    return closest;
 }
@@ -9,25 +9,47 @@
 
 #include "box.h"
 
+// Guides a box snaps to while it is transformed.
+// All guides are collected and sorted once when the transformation starts,
+// a snap is then a binary search without allocations.
 class Snapping
 {
 public:
+    // position of a snapped rect: the offset to move it by and the guide to show
+    struct Snap {
+        int offset;
+        int guide;
+    };
+
     Snapping() = default;
-    Snapping(std::vector<int> xGuides, std::vector<int> yGuides, std::vector<int> yMiddleGuides, int margin);
+    // guides of the edges and centres of the boxes and the edges of the slide, the centre of the
+    // slide is a separate middle guide. The moving rect snaps with equal spacing to pairs of boxes
+    // in its row or column, given the rect it has at the start of the transformation.
+    Snapping(Box::List const& boxes, QRect movingRect, QSize slideSize, int margin);
 
+    // snap single edges, e.g. while scaling
     std::optional<int> snapX(int position) const;
     std::optional<int> snapY(int position) const;
     std::optional<int> snapYMiddle(int position) const;
 
+    // snap the left edge, the centre or the right edge of a translated rect,
+    // whichever is closest, or the rect to equal spacing between boxes
+    std::optional<Snap> snapRectX(QRect rect) const;
+    std::optional<Snap> snapRectY(QRect rect) const;
+
     void setMargin(int margin);
 
 private:
-    std::optional<int> fittingSnapObjects(int position, std::vector<int> possibleSnappings) const;
+    std::optional<int> fittingSnapObjects(int position, std::vector<int> const& possibleSnappings) const;
+    std::optional<Snap> snapRect(int begin, int size, std::vector<int> const& guides, std::vector<int> const& spacings) const;
 
 private:
     std::vector<int> mXSnap;
     std::vector<int> mYSnap;
     std::vector<int> mYSnapMiddle;
+    // positions of the left / top edge of the moving rect with equal spacing to two boxes
+    std::vector<int> mXSpacing;
+    std::vector<int> mYSpacing;
     int mMargin = 25;
 };
 
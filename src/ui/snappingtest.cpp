@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#include "snappingtest.h"
+#include "snapping.h"
+#include "geometrybox.h"
+
+QTEST_GUILESS_MAIN(SnappingTest)
+
+namespace {
+auto const slideSize = QSize(1600, 900);
+
+Box::Ptr createBox(QRect rect) {
+    auto box = std::make_shared<GeometryBox>();
+    box->setGeometry(BoxGeometry(rect, 0));
+    return box;
+}
+
+// two boxes in a row with a gap of 100
+Box::List boxesInRow() {
+    return {createBox(QRect(0, 0, 100, 100)), createBox(QRect(200, 0, 100, 100))};
+}
+}
+
+void SnappingTest::testSnapEdges() {
+    Snapping snapping({createBox(QRect(400, 300, 200, 100))}, QRect(0, 0, 50, 50), slideSize, 10);
+    // edges and centre of the box
+    QCOMPARE(snapping.snapX(395), std::optional<int>(400));
+    QCOMPARE(snapping.snapX(503), std::optional<int>(500));
+    QCOMPARE(snapping.snapX(606), std::optional<int>(600));
+    QCOMPARE(snapping.snapY(352), std::optional<int>(350));
+    // edges of the slide
+    QCOMPARE(snapping.snapX(-5), std::optional<int>(0));
+    QCOMPARE(snapping.snapY(895), std::optional<int>(900));
+    // the margin is exclusive
+    QVERIFY(!snapping.snapX(410).has_value());
+    QVERIFY(!snapping.snapX(200).has_value());
+    // the centre of the slide is only a middle guide
+    QVERIFY(!snapping.snapY(450).has_value());
+    QCOMPARE(snapping.snapYMiddle(795), std::optional<int>(800));
+
+    snapping.setMargin(20);
+    QCOMPARE(snapping.snapX(415), std::optional<int>(400));
+}
+
+void SnappingTest::testSnapRect() {
+    Snapping snapping({createBox(QRect(400, 300, 200, 100))}, QRect(0, 0, 100, 50), slideSize, 10);
+    // the right edge is closer than the left one
+    auto const right = snapping.snapRectX(QRect(292, 600, 100, 50));
+    QVERIFY(right.has_value());
+    QCOMPARE(right->offset, 8);
+    QCOMPARE(right->guide, 400);
+    // the centre snaps to the centre of the box
+    auto const centre = snapping.snapRectX(QRect(447, 600, 100, 50));
+    QVERIFY(centre.has_value());
+    QCOMPARE(centre->offset, 3);
+    QCOMPARE(centre->guide, 500);
+    auto const top = snapping.snapRectY(QRect(700, 396, 100, 50));
+    QVERIFY(top.has_value());
+    QCOMPARE(top->offset, 4);
+    QCOMPARE(top->guide, 400);
+    QVERIFY(!snapping.snapRectX(QRect(700, 600, 100, 50)).has_value());
+}
+
+void SnappingTest::testSpacing() {
+    Snapping snapping(boxesInRow(), QRect(1000, 20, 50, 50), slideSize, 15);
+    // right of the pair with the same gap
+    auto const right = snapping.snapRectX(QRect(390, 20, 50, 50));
+    QVERIFY(right.has_value());
+    QCOMPARE(right->offset, 10);
+    QCOMPARE(right->guide, 400);
+    // centred between the pair
+    auto const between = snapping.snapRectX(QRect(134, 20, 50, 50));
+    QVERIFY(between.has_value());
+    QCOMPARE(between->offset, -9);
+    QCOMPARE(between->guide, 125);
+    // left of the pair with the same gap
+    auto const left = snapping.snapRectX(QRect(-140, 20, 50, 50));
+    QVERIFY(left.has_value());
+    QCOMPARE(left->offset, -10);
+    QCOMPARE(left->guide, -150);
+}
+
+void SnappingTest::testSpacingOtherRow() {
+    // the pair is in a row above the moving rect
+    Snapping snapping(boxesInRow(), QRect(1000, 500, 50, 50), slideSize, 15);
+    QVERIFY(!snapping.snapRectX(QRect(390, 500, 50, 50)).has_value());
+    QVERIFY(!snapping.snapRectY(QRect(390, 500, 50, 50)).has_value());
+}
@@ -0,0 +1,22 @@
+/*
+    SPDX-FileCopyrightText: 2020-2021 Theresa Gier <theresa@fam-gier.de>
+
+    SPDX-License-Identifier: LGPL-2.1-or-later
+*/
+
+#ifndef SNAPPINGTEST_H
+#define SNAPPINGTEST_H
+
+#include <QtTest/QTest>
+
+class SnappingTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSnapEdges();
+    void testSnapRect();
+    void testSpacing();
+    void testSpacingOtherRow();
+};
+
+#endif // SNAPPINGTEST_H
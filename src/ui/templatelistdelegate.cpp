@@ -1,6 +1,6 @@
 #include "templatelistdelegate.h"
 #include "presentation.h"
-#include "sliderenderer.h"
+#include "templatelistmodel.h"
 
 TemplateListDelegate::TemplateListDelegate(QObject *parent)
     : QAbstractItemDelegate(parent)
@@ -10,7 +10,8 @@ TemplateListDelegate::TemplateListDelegate(QObject *parent)
 
 void TemplateListDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const{
     auto const presentation = index.data(Qt::DisplayRole).value<Presentation::Ptr>();
-    auto const numberSlides = presentation->numberOfSlides();
+    auto const previews = index.data(TemplateListModel::PreviewRole).value<QList<QImage>>();
+    auto const numberSlides = numberOfSlides(presentation);
     auto const height = option.rect.height() - 2 * border;
     auto const width = ratio * height;
     auto const left = option.rect.left();
@@ -22,15 +23,16 @@ void TemplateListDelegate::paint(QPainter *painter, const QStyleOptionViewItem &
     }
 
     painter->save();
-    SlideRenderer paint{*painter};
-    auto const slideRect = QRect(0, 0, widthLogical, heightLogical);
-    painter->setWindow(slideRect);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
     for(int i = 0; i < numberSlides; i++) {
-        painter->setViewport(left + (border + width) * i + border, top + border, width, height);
-        auto const slide = presentation->slideList().slideAt(i);
-        painter->setClipRect(slideRect);
-        painter->fillRect(slideRect, Qt::white);
-        paint.paintSlide(slide);
+        auto const slideRect = QRect(left + (border + width) * i + border, top + border, width, height);
+        // slides that are not rendered yet are shown as placeholder
+        if(i < previews.size()) {
+            painter->drawImage(slideRect, previews[i]);
+        }
+        else {
+            painter->fillRect(slideRect, option.palette.midlight());
+        }
     }
     painter->restore();
 }
@@ -40,7 +42,14 @@ QSize TemplateListDelegate::sizeHint(const QStyleOptionViewItem &option,
 {
     auto const height = 140;
     auto const width = ratio * height;
-    auto const numberSlides = index.data(Qt::DisplayRole).value<Presentation::Ptr>().get()->numberOfSlides();
+    auto const numberSlides = numberOfSlides(index.data(Qt::DisplayRole).value<Presentation::Ptr>());
     auto const fullWidth = (width + border) * numberSlides + border;
     return QSize(fullWidth, height);
 }
+
+int TemplateListDelegate::numberOfSlides(std::shared_ptr<Presentation> const& presentation) const {
+    if(!presentation) {
+        return 1;
+    }
+    return presentation->numberOfSlides();
+}
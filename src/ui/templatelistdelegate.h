@@ -2,6 +2,9 @@
 #define TEMPLATELISTDELEGATE_H
 
 #include <qabstractitemdelegate.h>
+#include <memory>
+
+class Presentation;
 
 class TemplateListDelegate : public QAbstractItemDelegate
 {
@@ -14,6 +17,10 @@ public:
     QSize sizeHint(const QStyleOptionViewItem &option,
                    const QModelIndex &index) const override;
 
+private:
+    // a presentation that is not loaded yet is shown as one placeholder slide
+    int numberOfSlides(std::shared_ptr<Presentation> const& presentation) const;
+
 private:
     int const widthLogical = 1600;
     int const heightLogical = 900;
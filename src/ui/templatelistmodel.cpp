@@ -5,9 +5,94 @@
 */
 
 #include "templatelistmodel.h"
+#include "parser.h"
+#include "template.h"
+#include "sliderenderer.h"
+#include "displaylistcache.h"
+#include "latexcachemanager.h"
+
+#include <QCoreApplication>
+#include <QPainter>
+#include <QTimer>
+#include <QDir>
+
+namespace {
+
+// runs on a worker thread, must not touch any widget
+Presentation::Ptr loadTemplatePresentation(QString const& directory) {
+    QFile file(directory + "/demo.potato");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    auto const val = file.readAll();
+
+    auto presentation = std::make_shared<Presentation>();
+    presentation->setConfig({directory + "/demo.json"});
+
+    auto const parserOutput = generateSlides(val.toStdString(), directory);
+    if(!parserOutput.successfull()) {
+        return {};
+    }
+    auto templateName = parserOutput.preamble().templateName;
+    if (!QDir::isAbsolutePath(templateName)) {
+        templateName = directory + "/" + templateName;
+    }
+    Template::Ptr presentationTemplate = nullptr;
+    try {
+        presentationTemplate = loadTemplate(templateName);
+    }  catch (TemplateError) {
+    }
+    try {
+        presentation->setData({parserOutput.slideList(), presentationTemplate});
+    }  catch (PorpertyConversionError) {
+        return {};
+    }
+    // the presentation is handed over to the model, which lives in the main thread
+    presentation->moveToThread(QCoreApplication::instance()->thread());
+    return presentation;
+}
+
+}
+
+TemplateListModel::TemplateListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    connect(&cacheManager(), &LatexCacheManager::conversionFinished,
+            this, &TemplateListModel::invalidatePreviewsWithPendingLatex);
+}
+
+TemplateListModel::~TemplateListModel() {
+    mThreadPool.clear();
+    mThreadPool.waitForDone();
+}
+
+void TemplateListModel::loadTemplates(std::vector<QString> const& directories) {
+    beginResetModel();
+    mTemplates.clear();
+    for(auto const& directory : directories) {
+        mTemplates.push_back({directory, nullptr, {}});
+    }
+    endResetModel();
+
+    for(auto const& directory : directories) {
+        mThreadPool.start([this, directory]{
+            auto const presentation = loadTemplatePresentation(directory);
+            QMetaObject::invokeMethod(this, [this, directory, presentation]{
+                insertPresentation(directory, presentation);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+QString TemplateListModel::directory(int row) const {
+    if (row < 0 || row >= int(mTemplates.size())) {
+        return {};
+    }
+    return mTemplates[row].mDirectory;
+}
 
 int TemplateListModel::rowCount(const QModelIndex &) const {
-    return int(mPresentationList.size());
+    return int(mTemplates.size());
 }
 
 QVariant TemplateListModel::data(const QModelIndex &index, int role) const
@@ -15,21 +100,84 @@ QVariant TemplateListModel::data(const QModelIndex &index, int role) const
     if (!index.isValid())
         return QVariant();
 
-    if (index.row() >= int(mPresentationList.size()))
+    if (index.row() >= int(mTemplates.size()))
         return QVariant();
 
     if (role == Qt::DisplayRole){
         QVariant var;
-        auto slide = mPresentationList[index.row()];
-        var.setValue(slide);
+        auto presentation = mTemplates[index.row()].mPresentation;
+        var.setValue(presentation);
         return var;
     }
+    else if (role == PreviewRole) {
+        return QVariant::fromValue(mTemplates[index.row()].mPreviews);
+    }
     else
         return QVariant();
 }
 
-void TemplateListModel::setPresentationList(Presentation::List presentationList) {
-    beginResetModel();
-    mPresentationList = presentationList;
-    endResetModel();
+void TemplateListModel::insertPresentation(QString const& directory, Presentation::Ptr presentation) {
+    auto const entry = std::find_if(mTemplates.begin(), mTemplates.end(),
+                                    [&directory](auto const& entry){return entry.mDirectory == directory;});
+    if(entry == mTemplates.end()) {
+        return;
+    }
+    auto const row = int(std::distance(mTemplates.begin(), entry));
+    // templates that cannot be loaded are not offered
+    if(!presentation) {
+        beginRemoveRows(QModelIndex(), row, row);
+        mTemplates.erase(entry);
+        endRemoveRows();
+        return;
+    }
+    entry->mPresentation = presentation;
+    Q_EMIT dataChanged(index(row), index(row));
+    scheduleRenderPreview();
+}
+
+void TemplateListModel::scheduleRenderPreview() {
+    if(mRenderScheduled) {
+        return;
+    }
+    mRenderScheduled = true;
+    QTimer::singleShot(0, this, &TemplateListModel::renderNextPreview);
+}
+
+void TemplateListModel::renderNextPreview() {
+    mRenderScheduled = false;
+    // render one slide per call to keep the event loop responsive
+    for(int row = 0; row < int(mTemplates.size()); row++) {
+        auto& entry = mTemplates[row];
+        if(!entry.mPresentation || entry.mPreviews.size() >= entry.mPresentation->numberOfSlides()) {
+            continue;
+        }
+        auto const slideRect = QRect(QPoint(0, 0), entry.mPresentation->dimensions());
+        QImage preview(mPreviewSize, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&preview);
+        painter.setWindow(slideRect);
+        painter.fillRect(slideRect, Qt::white);
+        painter.setClipRect(slideRect);
+        SlideRenderer paint{painter};
+        paint.setDisplayListCache(&displayListCache());
+        paint.paintSlide(entry.mPresentation->slideList().slideAt(entry.mPreviews.size()));
+        painter.end();
+
+        entry.mPreviews.append(preview);
+        if(cacheManager().numberOfPendingJobs() > 0) {
+            entry.mLatexPending = true;
+        }
+        Q_EMIT dataChanged(index(row), index(row), {PreviewRole});
+        scheduleRenderPreview();
+        return;
+    }
+}
+
+void TemplateListModel::invalidatePreviewsWithPendingLatex() {
+    for(auto& entry : mTemplates) {
+        if(entry.mLatexPending) {
+            entry.mLatexPending = false;
+            entry.mPreviews.clear();
+            scheduleRenderPreview();
+        }
+    }
 }
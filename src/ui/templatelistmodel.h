@@ -7,6 +7,8 @@
 #ifndef TEMPLATELISTMODEL_H
 #define TEMPLATELISTMODEL_H
 #include <QAbstractListModel>
+#include <QThreadPool>
+#include <QImage>
 #include <vector>
 #include <memory>
 #include "slide.h"
@@ -16,16 +18,39 @@ class TemplateListModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
-    TemplateListModel(Presentation::List presentationList, QObject *parent = nullptr)
-        : QAbstractListModel(parent), mPresentationList(presentationList) {}
-    TemplateListModel(QObject *parent = nullptr)
-        : QAbstractListModel(parent){}
+    enum Roles {
+        // QList<QImage> with the already rendered slides of the template
+        PreviewRole = Qt::UserRole + 1
+    };
+
+    TemplateListModel(QObject *parent = nullptr);
+    ~TemplateListModel();
+
+    // Loads the demo presentations of the template directories on a thread pool.
+    // Until a presentation is loaded, its row holds no presentation and is shown as placeholder.
+    void loadTemplates(std::vector<QString> const& directories);
+    QString directory(int row) const;
 
-    void setPresentationList(Presentation::List presentationList);
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role) const override;
+
+private:
+    void insertPresentation(QString const& directory, Presentation::Ptr presentation);
+    void scheduleRenderPreview();
+    void renderNextPreview();
+    void invalidatePreviewsWithPendingLatex();
+
 private:
-    Presentation::List mPresentationList;
+    struct TemplateEntry {
+        QString mDirectory;
+        Presentation::Ptr mPresentation;
+        QList<QImage> mPreviews;
+        bool mLatexPending = false;
+    };
+    std::vector<TemplateEntry> mTemplates;
+    QThreadPool mThreadPool;
+    bool mRenderScheduled = false;
+    QSize const mPreviewSize{480, 270};
 };
 
 #endif // TEMPLATELISTMODEL_H
@@ -6,17 +6,53 @@
 
 #include "transformboxundo.h"
 
-TransformBoxUndo::TransformBoxUndo(std::shared_ptr<Presentation> presentation, ConfigBoxes configBefore, ConfigBoxes configAfter)
+namespace {
+int const mergeableTransformId = 1;
+}
+
+TransformBoxUndo::TransformBoxUndo(std::shared_ptr<Presentation> presentation, QString boxId, int pageNumber,
+                                   BoxGeometryState stateBefore, BoxGeometryState stateAfter, bool mergeable)
+    : mPresentation(presentation)
+    , mBoxId(boxId)
+    , mPageNumber(pageNumber)
+    , mStateBefore(stateBefore)
+    , mStateAfter(stateAfter)
+    , mMergeable(mergeable)
+{
+}
+
+void TransformBoxUndo::undo() {
+    mPresentation->setBoxGeometryState(mBoxId, mStateBefore, mPageNumber);
+}
+
+void TransformBoxUndo::redo() {
+    mPresentation->setBoxGeometryState(mBoxId, mStateAfter, mPageNumber);
+}
+
+int TransformBoxUndo::id() const {
+    return mMergeable ? mergeableTransformId : -1;
+}
+
+bool TransformBoxUndo::mergeWith(const QUndoCommand *other) {
+    auto const otherTransform = static_cast<TransformBoxUndo const*>(other);
+    if(otherTransform->mBoxId != mBoxId || otherTransform->mPresentation != mPresentation) {
+        return false;
+    }
+    mStateAfter = otherTransform->mStateAfter;
+    return true;
+}
+
+ConfigurationUndo::ConfigurationUndo(std::shared_ptr<Presentation> presentation, ConfigBoxes configBefore, ConfigBoxes configAfter)
     : mPresentation(presentation)
     , mConfigBefore(configBefore)
     , mConfigAfter(configAfter)
 {
 }
 
-void TransformBoxUndo::undo() {
+void ConfigurationUndo::undo() {
     mPresentation->setConfig(mConfigBefore);
 }
 
-void TransformBoxUndo::redo() {
+void ConfigurationUndo::redo() {
     mPresentation->setConfig(mConfigAfter);
 }
@@ -11,11 +11,32 @@
 #include <configboxes.h>
 #include <presentation.h>
 
-
+// Stores the geometry of one box before and after a transformation.
+// Consecutive mergeable commands (e.g. moving with the arrow keys) of the same box are merged.
 class TransformBoxUndo : public QUndoCommand
 {
 public:
-    TransformBoxUndo(std::shared_ptr<Presentation> presentation, ConfigBoxes configBefore, ConfigBoxes configAfter);
+    TransformBoxUndo(std::shared_ptr<Presentation> presentation, QString boxId, int pageNumber,
+                     BoxGeometryState stateBefore, BoxGeometryState stateAfter, bool mergeable = false);
+    void undo() override;
+    void redo() override;
+    int id() const override;
+    bool mergeWith(const QUndoCommand *other) override;
+
+private:
+    std::shared_ptr<Presentation> mPresentation;
+    QString mBoxId;
+    int mPageNumber;
+    BoxGeometryState mStateBefore;
+    BoxGeometryState mStateAfter;
+    bool mMergeable;
+};
+
+// Replaces the whole configuration, e.g. when recovering an autosave
+class ConfigurationUndo : public QUndoCommand
+{
+public:
+    ConfigurationUndo(std::shared_ptr<Presentation> presentation, ConfigBoxes configBefore, ConfigBoxes configAfter);
     void undo() override;
     void redo() override;
 